@@ -0,0 +1,23 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec3 aPos;
+// per frame, must match FrameUniforms and its std140 static_assert in source/BoardRenderer.h
+layout(std140) uniform FrameData
+{
+	mat4 view;
+	vec4 palette[4];
+};
+uniform mat4 translation_matrix;
+void main()
+{
+	gl_Position = view * translation_matrix * vec4(aPos, 1.0f);
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+uniform vec4 u_color;
+void main()
+{
+	FragColor = u_color;
+}
@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+// already in normalized device coordinates, drawn on top of everything
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec4 aColor;
+out vec4 color;
+void main()
+{
+	gl_Position = vec4(aPos, -0.5f, 1.0f);
+	color = aColor;
+}
+
+#shader fragment
+#version 330 core
+in vec4 color;
+out vec4 FragColor;
+void main()
+{
+	FragColor = color;
+}
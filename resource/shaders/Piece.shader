@@ -0,0 +1,60 @@
+#shader vertex
+#version 330 core
+// corner of the quad shared by all pieces, -1..1
+layout(location = 0) in vec2 aPos;
+// per instance
+layout(location = 1) in mat4 instance_matrix;  // takes locations 1-4
+layout(location = 5) in float instance_palette;  // index into palette
+layout(location = 6) in float instance_shape;  // 0 cross, 1 circle
+// per frame, must match FrameUniforms and its std140 static_assert in source/BoardRenderer.h
+layout(std140) uniform FrameData
+{
+	mat4 view;
+	vec4 palette[4];  // grid, cross, circle, winning line
+};
+// half the size of a piece before instance_matrix scales it to the cell
+const float EXTENT = 0.25f;
+out vec2 local;
+out vec4 color;
+flat out int shape;
+void main()
+{
+	local = aPos * EXTENT;
+	gl_Position = view * instance_matrix * vec4(local, 0.0f, 1.0f);
+	color = palette[int(instance_palette)];
+	shape = int(instance_shape);
+}
+
+#shader fragment
+#version 330 core
+in vec2 local;
+in vec4 color;
+flat in int shape;
+out vec4 FragColor;
+// in the same units as EXTENT
+const float CROSS_ARM = 0.18f;
+const float CIRCLE_RADIUS = 0.219f;
+const float HALF_THICKNESS = 0.016f;
+
+// distance to the segment from -a to a
+float Segment(vec2 p, vec2 a)
+{
+	float t = clamp(dot(p, a) / dot(a, a), -1.0f, 1.0f);
+	return length(p - a * t);
+}
+
+void main()
+{
+	float dist;
+	if (shape == 0)
+		dist = min(Segment(local, vec2(CROSS_ARM, CROSS_ARM)), Segment(local, vec2(CROSS_ARM, -CROSS_ARM)));
+	else
+		dist = abs(length(local) - CIRCLE_RADIUS);
+	dist -= HALF_THICKNESS;
+
+	// fade over one pixel, whatever the size of the window
+	float coverage = clamp(0.5f - dist / fwidth(dist), 0.0f, 1.0f);
+	if (coverage <= 0.0f)
+		discard;
+	FragColor = vec4(color.rgb, color.a * coverage);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Board.h"
+#include "Solver.h"
+#include "Mcts.h"
+
+
+// Anything that can choose a move. Agents keep all their state to themselves,
+// so every worker thread of a batch run owns its own agents and shares nothing.
+template<typename BoardType>
+class Agent
+{
+public:
+	virtual ~Agent() {}
+	// a cell that is empty on the board, the game isn't over
+	virtual int ChooseMove(const BoardType& board) = 0;
+};
+
+
+// Uniformly random empty cell.
+template<typename BoardType>
+class RandomAgent : public Agent<BoardType>
+{
+private:
+	uint64_t m_State;
+
+public:
+	explicit RandomAgent(uint64_t seed)
+		: m_State(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+	int ChooseMove(const BoardType& board) override
+	{
+		// xorshift
+		m_State ^= m_State << 13;
+		m_State ^= m_State >> 7;
+		m_State ^= m_State << 17;
+		int pick = static_cast<int>(((m_State >> 32) * static_cast<uint64_t>(BoardType::CELLS - board.MoveCount())) >> 32);
+		for (int cell = 0; cell < BoardType::CELLS; cell++)
+		{
+			if (board.IsEmpty(cell) && pick-- == 0)
+				return cell;
+		}
+		return -1;
+	}
+};
+
+
+// Perfect play, see Solver.
+template<typename BoardType>
+class SolverAgent : public Agent<BoardType>
+{
+private:
+	Solver<BoardType> m_Solver;
+
+public:
+	int ChooseMove(const BoardType& board) override { return m_Solver.BestMove(board); }
+	const Solver<BoardType>& GetSolver() const { return m_Solver; }
+};
+
+
+// Single-threaded MCTS with a playout budget, see Mcts.
+template<typename BoardType>
+class MctsAgent : public Agent<BoardType>
+{
+private:
+	Mcts<BoardType> m_Mcts;
+
+	static typename Mcts<BoardType>::Settings MakeSettings(uint64_t playouts)
+	{
+		typename Mcts<BoardType>::Settings settings;
+		settings.threads = 1;
+		settings.seconds = 0.0;
+		settings.playouts = playouts;
+		settings.max_nodes = playouts * 16;
+		return settings;
+	}
+
+public:
+	explicit MctsAgent(uint64_t playouts)
+		: m_Mcts(MakeSettings(playouts)) {}
+
+	int ChooseMove(const BoardType& board) override { return m_Mcts.Search(board); }
+};
+
+
+namespace agent_detail
+{
+	// the solver only compiles for boards that it can solve exactly
+	template<typename BoardType, bool SOLVABLE = (2 * BoardType::CELLS <= 64)>
+	struct MakeSolver
+	{
+		static Agent<BoardType>* Make() { return new SolverAgent<BoardType>(); }
+	};
+
+	template<typename BoardType>
+	struct MakeSolver<BoardType, false>
+	{
+		static Agent<BoardType>* Make() { return nullptr; }
+	};
+}
+
+// "random", "solver" or "mcts"; nullptr if the name is unknown or the agent can't play this board.
+template<typename BoardType>
+std::unique_ptr<Agent<BoardType>> MakeAgent(const std::string& name, uint64_t seed, uint64_t mcts_playouts = 1000)
+{
+	if (name == "random")
+		return std::unique_ptr<Agent<BoardType>>(new RandomAgent<BoardType>(seed));
+	if (name == "solver")
+		return std::unique_ptr<Agent<BoardType>>(agent_detail::MakeSolver<BoardType>::Make());
+	if (name == "mcts")
+		return std::unique_ptr<Agent<BoardType>>(new MctsAgent<BoardType>(mcts_playouts));
+	return nullptr;
+}
@@ -4,7 +4,8 @@
 #include <iostream>
 #include <vector>
 #include <array>
-#include <unordered_map>
+#include <ctime>
+#include <memory>
 
 
 // engine components
@@ -13,7 +14,18 @@
 #include "VertexBufferLayout.h"
 #include "VertexArray.h"
 #include "Shader.h"
-
+#include "BoardRenderer.h"
+#include "TournamentRenderer.h"
+#include "Profiler.h"
+#include "FramePacer.h"
+
+// game logic
+#include "Board.h"
+#include "BoardGeometry.h"
+#include "ComputerPlayer.h"
+#include "MoveAnalyzer.h"
+#include "Agent.h"
+#include "MoveLog.h"
 
 // math
 #include "glm/glm.hpp"
@@ -24,52 +36,85 @@
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_movement_callback(GLFWwindow* window, double xPos, double yPos);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 // process all input: query GLFW function whether the relevant key are pressed/released this frame and react accordingly
 void processInput(GLFWwindow* window);
-// Create a circle array
-void CreateCircle(float* circle_vertices, float x, float y, float z, float radius, const int fragments);
-// check if one of the figures filled cells/squares horizontally, vertically or diagonally.
-void WinCheck(int figure_number, char figure, int index);
+// put the figure of the side to move into the cell, false if the board refuses it
+bool PlaceFigure(int cell, MoveSource source);
+// take back the last move, and the computer's answer to it so it's the player's turn again
+void TakeBackMove();
+// start analyzing the position on the board if analysis mode is on, the analysis of the last one is dropped
+void AnalyzePosition();
+// tint of a cell for how the move there turns out, red (lost) over yellow (draw) to green (won)
+glm::vec4 HeatColor(float score);
+// clear the tournament boards and give each its first move time
+void StartTournament(double now);
+// play the moves of the tournament boards that are due
+void AdvanceTournament(double now);
+// print the click-to-swap latency percentiles measured since the last report, then start over
+void ReportLatency();
+// true while a mode changes the screen by itself, every frame is drawn then instead of waiting for events
+bool NeedsContinuousRedraw();
 
 // settings
 const float WIDTH = 690.0f;
 const float HEIGHT = 690.0f;
 
+// on-demand rendering: a frame is drawn only when something on the screen changed (or NeedsContinuousRedraw)
+bool needs_redraw = true;
+// print how many GL state changes were issued and skipped every frame (key F1)
+bool show_gl_counters = false;
+// frame-time graph at the bottom and averages in the title (key F3), frames are drawn continuously meanwhile
+bool show_profiler_overlay = false;
+// write the recorded frames to profile.json, open it in chrome://tracing (key F2)
+bool dump_profile = false;
+// latency mode: swap interval (key V), input sampled right before rendering instead of after
+// the swap (key I) and frame pacing (key L, see FramePacer), latency reported every few clicks
+int swap_interval = 1;
+bool late_input = false;
+const size_t LATENCY_REPORT_CLICKS = 20;
+// holds a fence only while fence pacing is on, it is turned off before the context goes away
+FramePacer frame_pacer;
+int framebuffer_width = static_cast<int>(WIDTH);
+int framebuffer_height = static_cast<int>(HEIGHT);
+
+// board settings: width, height and how many figures in a row win (e.g. Board<15, 15, 5> for Gomoku)
+using Game = Board<3, 3, 3>;
+const BoardGeometry geometry(Game::WIDTH, Game::HEIGHT);
 
-namespace circle_parameters
-{
-	const int NUMBER_OF_SIDES = 36;
-	const int NUMBER_OF_CIRCLE_LAYERS = 4;
-	const int DIMENSIONS = 3;
-	// multiply by 2 because each line has a two vertices.
-	const int NUMBER_OF_ELEMENTS = DIMENSIONS * 2 * NUMBER_OF_CIRCLE_LAYERS * NUMBER_OF_SIDES;
-}
-int current_circle_layer = 0;
 
 // figures logic
-glm::mat4 translation_matrix = glm::mat4(1.0f);
-int click_count = 0;
-glm::vec3 last_position = glm::vec3(0.0f, 0.0f, 0.0f);
 glm::vec3 position;
-glm::vec3 new_position;
-glm::vec3 delta_position;
-std::vector<glm::mat4> positions_of_figures;
-std::array<glm::vec3, 9> adjusted_positions = {
-	glm::vec3(0.0f,	  0.0f,   0.0f),
-	glm::vec3(0.67f,  0.0f,   0.0f),  // 0.67f is a length (width/height) of a cell/square
-	glm::vec3(-0.67f, 0.0f,   0.0f),
-	glm::vec3(0.0f,	  0.67f,  0.0f),
-	glm::vec3(0.0f,  -0.67f,  0.0f),
-	glm::vec3(0.67f,  0.67f,  0.0f),
-	glm::vec3(-0.67f, 0.67f,  0.0f),
-	glm::vec3(0.67f, -0.67f,  0.0f),
-	glm::vec3(-0.67f, -0.67f, 0.0f)
-};
-std::unordered_map<glm::vec3*, int> Position_Cache;
-bool win = false;
+// set when a figure is placed or the board is cleared, the instance buffers have to be refilled
+bool figures_changed = true;
+Game game_state;
 int winning_figure = -1;
-std::array<int, 3> winning_positions;
+
+// computer opponent: plays circles when turned on (key A), thinks on its own thread
+bool computer_opponent = false;
+ComputerPlayer<Game> computer;
+
+// analysis mode (key H): every move of the position is evaluated in the background and its cell
+// tinted as the results come in, a new position drops the analysis of the old one
+bool show_analysis = false;
+MoveAnalyzer<Game> analyzer;
+// set when the position changed, the tints of the old one come off with the next frame
+bool analysis_changed = false;
+
+// every move and reset of this session, replay it with tools/Replay.cpp
+MoveLogWriter move_log;
+
+// tournament view (key T): computer vs computer on many boards tiled over the window, drawn continuously
+bool tournament = false;
+const int TOURNAMENT_BOARDS = 100;
+// seconds between two moves on a board, and before a finished game starts over
+const double TOURNAMENT_MOVE_TIME = 0.25;
+const double TOURNAMENT_RESTART_TIME = 1.0;
+std::vector<Game> tournament_boards;
+std::vector<double> tournament_next_move;
+// shared by all boards, they take their turns one after another on this thread
+std::unique_ptr<Agent<Game>> tournament_agents[2];
 
 
 int main()
@@ -80,6 +125,9 @@ int main()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// drivers only promise debug output in a debug context, and every GL_CHECK_MODE uses it
+	// (in GL_CHECK_OFF it is the only error reporting there is)
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 
 	// GLFW: Create a window
 	GLFWwindow* window = glfwCreateWindow(static_cast<int>(WIDTH), static_cast<int>(HEIGHT), "TicTacToe", NULL, NULL);
@@ -91,6 +139,8 @@ int main()
 	}
 	// makes context of the window current for the calling thread.
 	glfwMakeContextCurrent(window);
+	glfwSwapInterval(swap_interval);
+	glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
 
 
 	// callback functions
@@ -98,6 +148,7 @@ int main()
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 	glfwSetCursorPosCallback(window, mouse_movement_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetKeyCallback(window, key_callback);
 
 	// glad: Load all OpenGL function pointers
 	//----------------------------------------
@@ -107,160 +158,179 @@ int main()
 		glfwTerminate();
 		return -1;
 	}
+	// let the driver report GL errors as they happen, see GLDebug.h for the glGetError modes of GLCall
+	if (!GLDebug::EnableDebugOutput(GL_CHECK_MODE == GL_CHECK_FULL) && GL_CHECK_MODE != GL_CHECK_FULL)
+		std::cout << "Warning: no GL debug output, GL errors are only checked by GLCall" << (GL_CHECK_MODE == GL_CHECK_OFF ? " (off)" : " (sampled)") << std::endl;
 
 
-	float grid[] = {
-		// left
-		-0.33f, -1.0f, 0.0f,
-		-0.33f,  1.0f, 0.0f,
-		// right
-		 0.33f, -1.0f, 0.0f,
-		 0.33f,  1.0f, 0.0f,
-		// up
-		-1.0f,  0.33f, 0.0f,
-		 1.0f,  0.33f, 0.0f,
-		// bottom
-		-1.0f, -0.33f, 0.0f,
-		 1.0f, -0.33f, 0.0f
-	};
-
-
-	float cross[] = {
-		// tilted to the right
-		-0.18f, -0.18f, 0.0f,
-		 0.18f,  0.18f, 0.0f,
-		// tilted to the left
-		 0.18f, -0.18f, 0.0f,
-		-0.18f,  0.18f, 0.0f,
-	};
-
-
-	{
-		// grid
-		//-----
-		Shader grid_shader("resource/shaders/Basic.shader");
-
-		VertexBuffer grid_vb(grid, sizeof(grid));
-		VertexArray grid_va;
-		VertexBufferLayout grid_layout;
-		grid_layout.Push<float>(3);  // 3 because we have only one attribute (position vertex)
-		grid_va.AddBuffer(grid_vb, grid_layout);
-
-
-		// cross
-		//------
-		VertexBuffer cross_vb(cross, sizeof(cross));
-		VertexArray cross_va;
-		VertexBufferLayout cross_layout;
-		cross_layout.Push<float>(3);
-		cross_va.AddBuffer(cross_vb, cross_layout);
-
-
-		// circle
-		//-------
-		float circle_vertices[circle_parameters::NUMBER_OF_ELEMENTS];
-		float radius = 0.21f;
-		for (int i = 0; i < circle_parameters::NUMBER_OF_CIRCLE_LAYERS; i++)
-		{
-			CreateCircle(circle_vertices, 0.0f, 0.0f, 0.0f, radius, circle_parameters::NUMBER_OF_SIDES);
-			radius += 0.006f;
-			current_circle_layer++;
-		}
-
-		VertexBuffer circle_vb(circle_vertices, sizeof(circle_vertices));
-		VertexArray circle_va;
-		VertexBufferLayout circle_layout;
-		circle_layout.Push<float>(3);
-		circle_va.AddBuffer(circle_vb, circle_layout);
-
+	// book of precomputed best moves, named after the board (width x height x in a row)
+	std::string book_path = "resource/book/" + std::to_string(Game::WIDTH) + "x" + std::to_string(Game::HEIGHT)
+		+ "x" + std::to_string(Game::IN_A_ROW) + ".book";
+	if (!computer.LoadBook(book_path))
+		std::cout << "Warning: no opening book at " << book_path << ", the computer will search every move" << std::endl;
+	// wake the render loop up when the computer has made up its mind
+	computer.SetOnReady(glfwPostEmptyEvent);
+	analyzer.SetOnResult(glfwPostEmptyEvent);
 
-		// unbind
-		//-------
-		grid_shader.Unbind();
-		grid_vb.Unbind();
-		grid_va.Unbind();
+	// perfect play against random moves, boards too big for the solver get MCTS
+	tournament_agents[0] = MakeAgent<Game>("solver", 1);
+	if (tournament_agents[0] == nullptr)
+		tournament_agents[0] = MakeAgent<Game>("mcts", 1, 200);
+	tournament_agents[1] = MakeAgent<Game>("random", 2);
 
-		cross_vb.Unbind();
-		cross_va.Unbind();
+	std::string log_path = "moves-" + std::to_string(static_cast<long long>(std::time(nullptr))) + ".log";
+	if (!move_log.Open(log_path, Game::WIDTH, Game::HEIGHT, Game::IN_A_ROW))
+		std::cout << "Warning: can't write the move log " << log_path << std::endl;
 
-		circle_vb.Unbind();
-		circle_va.Unbind();
-		//-------
 
+	// linked shader programs, the second start loads them instead of compiling
+	Shader::SetCacheDirectory("shader-cache");
 
-		glm::mat4 grid_translation_matrix = glm::mat4(1.0f);
+	{
+		BoardRenderer board_renderer(geometry, framebuffer_width, framebuffer_height);
+		TournamentRenderer tournament_renderer(geometry, Game::CELLS, TOURNAMENT_BOARDS);
+
+		// profiler overlay
+		//-----------------
+		Shader overlay_shader("resource/shaders/Overlay.shader");
+		VertexBuffer overlay_vb(nullptr, 0, GL_DYNAMIC_DRAW);
+		VertexArray overlay_va;
+		VertexBufferLayout overlay_layout;
+		overlay_layout.Push<float>(2);
+		overlay_layout.Push<float>(4);
+		overlay_va.AddBuffer(overlay_vb, overlay_layout);
+		std::vector<float> overlay_vertices;
+		double overlay_title_time = 0.0;
+
+		const Shader::LoadStatistics& shader_statistics = Shader::GetLoadStatistics();
+		std::cout << "Shaders: " << shader_statistics.programs << " programs (" << shader_statistics.cache_hits
+			<< " from the cache) in " << shader_statistics.seconds * 1000.0 << " ms" << std::endl;
 
 		Renderer renderer;
+		Profiler profiler;
 
 		// renderer loop
 		//--------------
 		while (!glfwWindowShouldClose(window))
 		{
+			profiler.BeginFrame();
 			// input
 			//------
-			processInput(window);
-
-			// render
-			//-------
-			renderer.Clear();
-
-			grid_shader.Bind();
+			{
+				Profiler::Zone zone(profiler, Profiler::PHASE_INPUT);
+				// with pacing the GPU catches up first, late input is then as fresh as it gets
+				frame_pacer.WaitForGpu();
+				if (late_input)
+					glfwPollEvents();
+				processInput(window);
+			}
+			{
+				Profiler::Zone zone(profiler, Profiler::PHASE_LOGIC);
+				// the computer's move, once it has finished thinking
+				int computer_cell = computer.TakeMove();
+				if (computer_cell != -1)
+					PlaceFigure(computer_cell, SOURCE_COMPUTER);
+				// the analysis results that came in since the last frame
+				if (analysis_changed)
+				{
+					board_renderer.ClearCellColors();
+					analysis_changed = false;
+					needs_redraw = true;
+				}
+				MoveAnalyzer<Game>::Result analysis;
+				while (analyzer.Poll(analysis))
+				{
+					board_renderer.SetCellColor(analysis.cell, HeatColor(analysis.score));
+					needs_redraw = true;
+				}
+				if (tournament)
+					AdvanceTournament(glfwGetTime());
+			}
 
-			grid_vb.Bind();
-			grid_va.Bind();
-			grid_shader.SetUniform4f("u_color", 0.05f, 0.45f, 0.35f, 1.0f);
-			grid_shader.SetUniformMat4f("translation_matrix", grid_translation_matrix);
-			renderer.Draw(grid_va, grid_shader, sizeof(grid) / 3);
+			if (dump_profile)
+			{
+				if (profiler.WriteTrace("profile.json"))
+					std::cout << "Profile written to profile.json" << std::endl;
+				else
+					std::cout << "Failed to write profile.json" << std::endl;
+				dump_profile = false;
+			}
 
+			if (!needs_redraw && !figures_changed && !NeedsContinuousRedraw())
+			{
+				// glfw: sleep until there are events (for instance, keyboard input, mouse movement, etc.)
+				glfwWaitEvents();
+				continue;
+			}
+			needs_redraw = false;
 
-			// draw all currently existing figures.
-			//-------------------------------------
-			for (int i = 0; i < positions_of_figures.size(); i++)
+			// render
+			//-------
 			{
-				if (i % 2 == 0 || i == 0)
+				Profiler::Zone render_zone(profiler, Profiler::PHASE_RENDER);
+				profiler.BeginGpu();
+				renderer.BeginFrame();
+				if (tournament)
+					tournament_renderer.Render(renderer, tournament_boards, framebuffer_width, framebuffer_height);
+				else
 				{
-					glLineWidth(10.0f);
-					cross_vb.Bind();
-					cross_va.Bind();
-					if (winning_figure == 0)
+					if (figures_changed)
 					{
-						if (winning_positions[0] == i || winning_positions[1] == i || winning_positions[2] == i)
-							grid_shader.SetUniform4f("u_color", 1.0f, 0.7f, 0.8f, 1.0f);
-						else
-							grid_shader.SetUniform4f("u_color", 1.0f, 1.0f, 1.0f, 1.0f);
+						board_renderer.SetBoard(game_state);
+						figures_changed = false;
 					}
-					else
-						grid_shader.SetUniform4f("u_color", 1.0f, 1.0f, 1.0f, 1.0f);
-					grid_shader.SetUniformMat4f("translation_matrix", positions_of_figures[i]);
-					renderer.Draw(cross_va, grid_shader, sizeof(cross) / 3);
+					board_renderer.Render(renderer, framebuffer_width, framebuffer_height);
 				}
-				else if (i % 2 != 0)
+
+				if (show_profiler_overlay)
 				{
-					glLineWidth(3.5f);
-					circle_vb.Bind();
-					circle_va.Bind();
-					if (winning_figure == 1)
+					profiler.BuildGraph(overlay_vertices);
+					overlay_vb.SetData(overlay_vertices.data(), static_cast<int>(overlay_vertices.size() * sizeof(float)));
+					if (!overlay_vertices.empty())
+						renderer.Submit({ &overlay_shader, &overlay_va, GL_TRIANGLES, static_cast<int>(overlay_vertices.size()) / 6, 1, 0.0f,
+							Uniform(), nullptr, Uniform(), nullptr });
+					// the title is the only text we can draw, twice a second is enough to read it
+					if (glfwGetTime() - overlay_title_time > 0.5)
 					{
-							if (winning_positions[0] == i || winning_positions[1] == i || winning_positions[2] == i)
-								grid_shader.SetUniform4f("u_color", 1.0f, 0.7f, 0.8f, 1.0f);
-							else
-								grid_shader.SetUniform4f("u_color", 0.0f, 0.0f, 0.0f, 0.0f);
+						glfwSetWindowTitle(window, ("TicTacToe | " + profiler.Summary()).c_str());
+						overlay_title_time = glfwGetTime();
 					}
-					else
-						grid_shader.SetUniform4f("u_color", 0.0f, 0.0f, 0.0f, 0.0f);
-					grid_shader.SetUniformMat4f("translation_matrix", positions_of_figures[i]);
-					renderer.DrawCircle(circle_va, grid_shader, circle_parameters::NUMBER_OF_ELEMENTS / 3);
+					renderer.Flush();
 				}
+				profiler.EndGpu();
+			}
+
+			if (show_gl_counters)
+			{
+				const GLState::Counters& counters = GLState::GetCounters();
+				std::cout << "Frame: " << counters.draw_calls << " draw calls, " << counters.issued << " state changes issued, "
+					<< counters.elided << " elided" << std::endl;
 			}
-			glLineWidth(5.0f);
 
 
 			// glfw: swap the buffers (front and back) to avoid flickering
-			glfwSwapBuffers(window);
-			// glfw: poll events (for instance, keyboard input, mouse movement, etc.)
-			glfwPollEvents();
+			{
+				Profiler::Zone zone(profiler, Profiler::PHASE_SWAP);
+				glfwSwapBuffers(window);
+				frame_pacer.AfterSwap();
+			}
+			// glfw: take the events that came while drawing, the next iteration waits for more
+			if (!late_input)
+			{
+				Profiler::Zone zone(profiler, Profiler::PHASE_INPUT);
+				glfwPollEvents();
+			}
+			if (frame_pacer.GetLatencySamples() >= LATENCY_REPORT_CLICKS)
+				ReportLatency();
+			profiler.EndFrame();
 		}
+		ReportLatency();
+		frame_pacer.SetMode(FramePacer::PACING_OFF);
 	}
+	// no more wake-ups once glfw is gone: the computer's thread and the analysis tasks end before it
+	computer.Cancel();
+	analyzer.Cancel();
+	analyzer.Wait();
 	glfwTerminate();
 	return 0;
 }
@@ -270,15 +340,6 @@ void processInput(GLFWwindow* window)
 {
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
-	if (glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS)
-	{
-		click_count = 0;
-		// erase (clean up (clear)) some cache where positions of x and o are stored
-		positions_of_figures.clear();
-		Position_Cache.clear();
-		win = false;
-		winning_figure = -1;
-	}
 }
 
 
@@ -286,6 +347,9 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	// make sure the viewport matches the new window dimensions
 	GLCall(glViewport(0, 0, width, height));
+	framebuffer_width = width;
+	framebuffer_height = height;
+	needs_redraw = true;
 }
 
 
@@ -299,128 +363,190 @@ void mouse_movement_callback(GLFWwindow* window, double xPos, double yPos)
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
-	// checking if the left mouse button is pressed and it's pressed no more than 9 times
-	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && click_count < 9 && win == false)
+	// checking if the left mouse button is pressed, the game is still going and it's the player's turn
+	// (while the computer's answer waits for the render loop to take it, it's still the computer's turn)
+	bool computer_to_move = computer_opponent && game_state.ToMove() == Figure::Circle;
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !tournament && !game_state.IsOver()
+		&& !computer.IsThinking() && !computer_to_move)
 	{
-		for (int i = 0; i < 9; i++)
+		int cell = geometry.CellAt(position.x, position.y);
+		// Fill only empty cell/square, the board refuses the others (clicks on them are logged all the same)
+		if (cell != -1 && PlaceFigure(cell, SOURCE_HUMAN))
 		{
-			// choose the most suitable adjusted position
-			if (abs(position.x - adjusted_positions[i].x) < 0.33f && abs(position.y - adjusted_positions[i].y) < 0.33f)
-			{
-				// Position has already been using (this cell/square is filled)
-				// !! But there is no need to check for 0 value (when checking... if u_map[key] == value, value 0 is automatically filled to the place with key)
-				if (Position_Cache.find(&adjusted_positions[i]) != Position_Cache.end() && Position_Cache[&adjusted_positions[i]] != 0)
-					break;
-				new_position = adjusted_positions[i];
-				if (click_count % 2 == 0 || click_count == 0)  // cross
-					Position_Cache[&adjusted_positions[i]] = click_count + 2;  // +2 to exclude 0
-				else if (click_count % 2 != 0)                 // circle
-					Position_Cache[&adjusted_positions[i]] = click_count + 2;
-
-				// checking on win
-				//----------------
-				WinCheck(0, 'x', i);
-				if (win != true)
-					WinCheck(1, 'o', i);
-				break;
-			}
+			// from when GLFW hands over the click, the time it waited in the event queue isn't known
+			frame_pacer.MarkInput();
+			if (computer_opponent && !game_state.IsOver())
+				computer.Start(game_state);
 		}
-		// Fill only empty cell/square
-		if (new_position != last_position || click_count == 0)
+	}
+}
+
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_A && action == GLFW_PRESS)
+	{
+		computer_opponent = !computer_opponent;
+		std::cout << "Computer opponent: " << (computer_opponent ? "on" : "off") << std::endl;
+		// it's the computer's turn already
+		if (computer_opponent && !game_state.IsOver() && game_state.ToMove() == Figure::Circle)
+			computer.Start(game_state);
+		else if (!computer_opponent)
+			computer.Cancel();
+	}
+	if (key == GLFW_KEY_ENTER && action == GLFW_PRESS)
+	{
+		// erase (clean up (clear)) the board, once per press: holding the key doesn't restart the computer and the analysis
+		if (game_state.MoveCount() > 0)
+			move_log.Append(EVENT_RESET, SOURCE_HUMAN, 0);
+		figures_changed = true;
+		game_state = Game();
+		computer.Cancel();
+		AnalyzePosition();
+		winning_figure = -1;
+	}
+	if (key == GLFW_KEY_H && action == GLFW_PRESS)
+	{
+		show_analysis = !show_analysis;
+		std::cout << "Analysis: " << (show_analysis ? "on" : "off") << std::endl;
+		AnalyzePosition();
+	}
+	if (key == GLFW_KEY_BACKSPACE && (action == GLFW_PRESS || action == GLFW_REPEAT) && !tournament)
+		TakeBackMove();
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+	{
+		tournament = !tournament;
+		std::cout << "Tournament: " << (tournament ? "on" : "off") << std::endl;
+		if (tournament)
+			StartTournament(glfwGetTime());
+		needs_redraw = true;
+	}
+	if ((key == GLFW_KEY_V || key == GLFW_KEY_I || key == GLFW_KEY_L) && action == GLFW_PRESS)
+	{
+		// the samples so far belong to the old settings
+		ReportLatency();
+		if (key == GLFW_KEY_V)
 		{
-			click_count++;
-			// find offset of the mouse
-			delta_position = new_position - last_position;
-			// update old position to the new position
-			last_position = new_position;
-			translation_matrix = glm::translate(translation_matrix, delta_position);
-			positions_of_figures.push_back(translation_matrix);
+			swap_interval = 1 - swap_interval;
+			glfwSwapInterval(swap_interval);
 		}
+		else if (key == GLFW_KEY_I)
+			late_input = !late_input;
+		else
+			frame_pacer.SetMode(static_cast<FramePacer::Mode>((frame_pacer.GetMode() + 1) % FramePacer::PACING_COUNT));
+		std::cout << "Latency mode: swap interval " << swap_interval << ", input " << (late_input ? "before rendering" : "after the swap")
+			<< ", pacing " << FramePacer::ModeName(frame_pacer.GetMode()) << std::endl;
+	}
+	if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+		show_gl_counters = !show_gl_counters;
+	if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
+		dump_profile = true;
+	if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+	{
+		show_profiler_overlay = !show_profiler_overlay;
+		if (!show_profiler_overlay)
+			glfwSetWindowTitle(window, "TicTacToe");
+		needs_redraw = true;
 	}
 }
 
 
-void CreateCircle(float* circle_vertices, float x, float y, float z, float radius, const int fragments)
+bool PlaceFigure(int cell, MoveSource source)
 {
-	const float doublePI = 2.0f * 3.1415926f;
-	int number_of_vertices = circle_parameters::NUMBER_OF_ELEMENTS / circle_parameters::DIMENSIONS / circle_parameters::NUMBER_OF_CIRCLE_LAYERS;
+	move_log.Append(EVENT_MOVE, source, cell);
+	if (!game_state.Play(cell))
+		return false;
+	winning_figure = static_cast<int>(game_state.Winner());
+	figures_changed = true;
+	// the analysis of the old position is stale now, whether the move came from a click or the computer
+	AnalyzePosition();
+	return true;
+}
+
 
-	for (int i = 0; i < number_of_vertices; i++)
+void TakeBackMove()
+{
+	computer.Cancel();
+	if (game_state.MoveCount() == 0)
+		return;
+	move_log.Append(EVENT_UNDO, SOURCE_HUMAN, game_state.LastMove());
+	game_state.Undo();
+	if (computer_opponent && game_state.ToMove() == Figure::Circle && game_state.MoveCount() > 0)
 	{
-		circle_vertices[( i + number_of_vertices * current_circle_layer) * 3] = (radius * cos(i * doublePI / fragments)) + x;  // (i * 3)
-		circle_vertices[((i + number_of_vertices * current_circle_layer) * 3) + 1] = (radius * sin(i * doublePI / fragments)) + y;  // (i * 3) + 1
-		circle_vertices[((i + number_of_vertices * current_circle_layer) * 3) + 2] = 0.0f + z;  // (i * 3) + 2
+		move_log.Append(EVENT_UNDO, SOURCE_HUMAN, game_state.LastMove());
+		game_state.Undo();
 	}
+	winning_figure = static_cast<int>(game_state.Winner());
+	figures_changed = true;
+	AnalyzePosition();
 }
 
 
-void WinCheck(int mod, char figure, int i)
+void AnalyzePosition()
 {
-	// set matches to 0 because we include current vector
-	int matches_horizontally = 0, matches_vertically = 0,
-		matches_rl_diagonally = 0, matches_lr_diagonally = 0;
-	// track winning positions
-	std::array<int, 3> winning_horizontally, winning_vertically,
-						winning_rl_diagonally, winning_lr_diagonally;
-
-	for (int j = 0; j < 9; j++)
+	if (show_analysis)
+		analyzer.Start(game_state);
+	else
+		analyzer.Cancel();
+	analysis_changed = true;
+}
+
+
+glm::vec4 HeatColor(float score)
+{
+	// translucent, the grid shows through
+	if (score < 0.0f)
+		return glm::vec4(0.9f, 0.8f * (1.0f + score), 0.1f, 0.5f);
+	return glm::vec4(0.9f * (1.0f - score), 0.8f, 0.1f, 0.5f);
+}
+
+
+
+bool NeedsContinuousRedraw()
+{
+	// the tournament plays on its own, the profiler graph shows every frame
+	return tournament || show_profiler_overlay;
+}
+
+
+void ReportLatency()
+{
+	FramePacer::LatencyReport report = frame_pacer.GetLatency();
+	frame_pacer.ResetLatency();
+	if (report.samples == 0)
+		return;
+	std::cout << "Input latency, click to swap, over " << report.samples << " clicks: p50 " << report.p50_ms << " ms, p99 "
+		<< report.p99_ms << " ms, max " << report.max_ms << " ms (swap interval " << swap_interval << ", input "
+		<< (late_input ? "before rendering" : "after the swap") << ", pacing " << FramePacer::ModeName(frame_pacer.GetMode()) << ")" << std::endl;
+}
+
+
+void StartTournament(double now)
+{
+	tournament_boards.assign(TOURNAMENT_BOARDS, Game());
+	tournament_next_move.resize(TOURNAMENT_BOARDS);
+	// spread over one move time, so not every board moves in the same frame
+	for (int i = 0; i < TOURNAMENT_BOARDS; i++)
+		tournament_next_move[i] = now + TOURNAMENT_MOVE_TIME * i / TOURNAMENT_BOARDS;
+}
+
+
+void AdvanceTournament(double now)
+{
+	for (int i = 0; i < TOURNAMENT_BOARDS; i++)
 	{
-		// horizontally
-		if (Position_Cache[&adjusted_positions[i]] != 0 && Position_Cache[&adjusted_positions[j]] != 0)
+		if (now < tournament_next_move[i])
+			continue;
+		Game& board = tournament_boards[i];
+		if (board.IsOver())
 		{
-			if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
-				&& (adjusted_positions[i].y == adjusted_positions[j].y))
-			{
-				// store current (at the each time) number of clicks (number of clicks equals to the index of vector "positions_of_figures")
-				winning_horizontally[matches_horizontally] = Position_Cache[&adjusted_positions[j]] - 2;  // -2 because origin value has been increased on 2
-				matches_horizontally++;
-				if (matches_horizontally == 3)
-				{
-					winning_positions = winning_horizontally;
-					win = true;
-					break;
-				}
-			}
-			// vertically
-			if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
-				&& (adjusted_positions[i].x == adjusted_positions[j].x))
-			{
-				winning_vertically[matches_vertically] = Position_Cache[&adjusted_positions[j]] - 2;
-				matches_vertically++;
-				if (matches_vertically == 3)
-				{
-					winning_positions = winning_vertically;
-					win = true;
-					break;
-				}
-			}
-			// diagonally
-			if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
-				&& (adjusted_positions[j].x == -adjusted_positions[j].y))
-			{
-				winning_lr_diagonally[matches_lr_diagonally] = Position_Cache[&adjusted_positions[j]] - 2;
-				matches_lr_diagonally++;
-				if (matches_lr_diagonally == 3)
-				{
-					winning_positions = winning_lr_diagonally;
-					win = true;
-					break;
-				}
-			}
-			if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
-				&& (adjusted_positions[j].x == adjusted_positions[j].y))
-			{
-				winning_rl_diagonally[matches_rl_diagonally] = Position_Cache[&adjusted_positions[j]] - 2;
-				matches_rl_diagonally++;
-				if (matches_rl_diagonally == 3)
-				{
-					winning_positions = winning_rl_diagonally;
-					win = true;
-					break;
-				}
-			}
+			board = Game();
+			tournament_next_move[i] = now + TOURNAMENT_MOVE_TIME;
+			continue;
 		}
+		// the agents take turns at playing crosses from one board to the next
+		int agent = (i + static_cast<int>(board.ToMove())) % 2;
+		board.Play(tournament_agents[agent]->ChooseMove(board));
+		tournament_next_move[i] = now + (board.IsOver() ? TOURNAMENT_RESTART_TIME : TOURNAMENT_MOVE_TIME);
 	}
-	if (win == true)
-		winning_figure = mod;
 }
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <type_traits>
+
+
+// values match the order of turns (cross goes first)
+enum class Figure : int8_t
+{
+	None = -1, Cross = 0, Circle = 1
+};
+
+
+namespace board_detail
+{
+	// Smallest unsigned integer that has a bit for every cell, std::bitset for bigger boards.
+	template<int CELLS>
+	struct MaskFor
+	{
+		using Type = typename std::conditional<(CELLS <= 16), uint16_t,
+			typename std::conditional<(CELLS <= 32), uint32_t,
+			typename std::conditional<(CELLS <= 64), uint64_t,
+			std::bitset<CELLS>>::type>::type>::type;
+	};
+
+	// The few operations the board needs, for integer masks...
+	template<typename Mask>
+	struct MaskOps
+	{
+		static Mask Bit(int cell) { return static_cast<Mask>(Mask(1) << cell); }
+		static bool Any(Mask mask) { return mask != 0; }
+		static int Count(Mask mask) { return static_cast<int>(std::bitset<64>(mask).count()); }
+		static Mask Full(int cells) { return cells == 64 ? static_cast<Mask>(~0ull) : static_cast<Mask>((1ull << cells) - 1); }
+		static int Lowest(Mask mask)
+		{
+			int cell = 0;
+			for (; (mask & 1) == 0; mask >>= 1)
+				cell++;
+			return cell;
+		}
+	};
+
+	// ...and for std::bitset
+	template<std::size_t N>
+	struct MaskOps<std::bitset<N>>
+	{
+		using Mask = std::bitset<N>;
+		static Mask Bit(int cell) { Mask mask; mask.set(cell); return mask; }
+		static bool Any(const Mask& mask) { return mask.any(); }
+		static int Count(const Mask& mask) { return static_cast<int>(mask.count()); }
+		static Mask Full(int) { return Mask().set(); }
+		static int Lowest(const Mask& mask)
+		{
+			int cell = 0;
+			while (!mask.test(cell))
+				cell++;
+			return cell;
+		}
+	};
+
+
+	// All lines of K cells on a W x H board, built at compile time.
+	// through[cell] lists the lines that contain the cell and ends with -1.
+	template<int W, int H, int K>
+	struct LineTable
+	{
+		static const int CELLS = W * H;
+		// how many lines fit along a side of n cells
+		static constexpr int Fit(int n) { return n >= K ? n - K + 1 : 0; }
+		static const int NUMBER_OF_LINES = Fit(W) * H + W * Fit(H) + 2 * Fit(W) * Fit(H);
+
+		uint64_t lines[NUMBER_OF_LINES];
+		int16_t through[CELLS][4 * K + 1];
+
+		constexpr LineTable()
+			: lines(), through()
+		{
+			// horizontal, vertical and both diagonal directions as (column, row) steps
+			const int dx[4] = { 1, 0, 1, -1 };
+			const int dy[4] = { 0, 1, 1,  1 };
+			int count[CELLS] = {};
+			int line = 0;
+			for (int direction = 0; direction < 4; direction++)
+			{
+				for (int row = 0; row < H; row++)
+				{
+					for (int column = 0; column < W; column++)
+					{
+						int last_column = column + dx[direction] * (K - 1);
+						int last_row = row + dy[direction] * (K - 1);
+						if (last_column < 0 || last_column >= W || last_row >= H)
+							continue;
+						for (int i = 0; i < K; i++)
+						{
+							int cell = (row + dy[direction] * i) * W + column + dx[direction] * i;
+							lines[line] |= 1ull << cell;
+							through[cell][count[cell]++] = static_cast<int16_t>(line);
+						}
+						line++;
+					}
+				}
+			}
+			for (int cell = 0; cell < CELLS; cell++)
+				through[cell][count[cell]] = -1;
+		}
+	};
+
+
+	// Finds a line of K figures that was completed by a move into `cell`.
+	// Boards up to 64 cells check the precomputed lines through the cell.
+	template<int W, int H, int K, bool SMALL = (W * H <= 64)>
+	struct WinDetector
+	{
+		using Mask = typename MaskFor<W * H>::Type;
+		static constexpr LineTable<W, H, K> TABLE = LineTable<W, H, K>();
+
+		static Mask Find(const Mask& figures, int cell)
+		{
+			for (const int16_t* line = TABLE.through[cell]; *line != -1; line++)
+			{
+				Mask mask = static_cast<Mask>(TABLE.lines[*line]);
+				if ((figures & mask) == mask)
+					return mask;
+			}
+			return Mask(0);
+		}
+
+		// any complete line, wherever it is
+		static bool Any(const Mask& figures)
+		{
+			for (uint64_t line : TABLE.lines)
+			{
+				Mask mask = static_cast<Mask>(line);
+				if ((figures & mask) == mask)
+					return true;
+			}
+			return false;
+		}
+	};
+
+	template<int W, int H, int K, bool SMALL>
+	constexpr LineTable<W, H, K> WinDetector<W, H, K, SMALL>::TABLE;
+
+	// Bigger boards shift the whole bitset along each direction and AND it K-1 times,
+	// what is left are the first cells of complete lines.
+	template<int W, int H, int K>
+	struct WinDetector<W, H, K, false>
+	{
+		using Mask = std::bitset<W * H>;
+
+		// cells where a line in the direction can start without wrapping around the board
+		static const Mask& Starts(int direction)
+		{
+			static const Mask starts[4] = { MakeStarts(1, 0), MakeStarts(0, 1), MakeStarts(1, 1), MakeStarts(-1, 1) };
+			return starts[direction];
+		}
+
+		static Mask MakeStarts(int dx, int dy)
+		{
+			Mask mask;
+			for (int row = 0; row < H; row++)
+			{
+				for (int column = 0; column < W; column++)
+				{
+					int last_column = column + dx * (K - 1);
+					if (last_column >= 0 && last_column < W && row + dy * (K - 1) < H)
+						mask.set(row * W + column);
+				}
+			}
+			return mask;
+		}
+
+		static Mask Find(const Mask& figures, int)
+		{
+			const int shifts[4] = { 1, W, W + 1, W - 1 };
+			for (int direction = 0; direction < 4; direction++)
+			{
+				Mask runs = figures & Starts(direction);
+				for (int i = 1; i < K && runs.any(); i++)
+					runs &= figures >> (shifts[direction] * i);
+				if (runs.any())
+				{
+					int start = MaskOps<Mask>::Lowest(runs);
+					Mask line;
+					for (int i = 0; i < K; i++)
+						line.set(start + shifts[direction] * i);
+					return line;
+				}
+			}
+			return Mask();
+		}
+
+		static bool Any(const Mask& figures) { return Find(figures, 0).any(); }
+	};
+
+
+	// Random keys for Zobrist hashing: one per figure and cell, and one that flips with the
+	// side to move. Drawn from splitmix64 at compile time, so hashes are the same in every run.
+	template<int CELLS>
+	struct ZobristKeys
+	{
+		uint64_t cells[2][CELLS];
+		uint64_t side;
+
+		constexpr ZobristKeys()
+			: cells(), side()
+		{
+			uint64_t state = 0;
+			for (int figure = 0; figure < 2; figure++)
+			{
+				for (int cell = 0; cell < CELLS; cell++)
+					cells[figure][cell] = Next(state);
+			}
+			side = Next(state);
+		}
+
+		static constexpr uint64_t Next(uint64_t& state)
+		{
+			uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+	};
+
+	template<int CELLS>
+	struct Zobrist
+	{
+		static constexpr ZobristKeys<CELLS> KEYS = ZobristKeys<CELLS>();
+	};
+
+	template<int CELLS>
+	constexpr ZobristKeys<CELLS> Zobrist<CELLS>::KEYS;
+}
+
+
+// Plain value type holding a game on a W x H board where K figures in a row win.
+// One bit per cell for each figure, cell i is counted row by row from the top-left cell:
+//   0 | 1 | 2
+//   3 | 4 | 5
+//   6 | 7 | 8
+// The moves are kept on a stack, so a search can Play and Undo on one board instead of
+// copying it, and a Zobrist hash of the position is updated along with them.
+// No GL dependency, so the window, the AI and batch tools can all share it.
+template<int W, int H, int K>
+class Board
+{
+	static_assert(K <= W || K <= H, "Board: K figures in a row don't fit on the board");
+
+public:
+	static const int WIDTH = W;
+	static const int HEIGHT = H;
+	static const int IN_A_ROW = K;
+	static const int CELLS = W * H;
+
+	using Mask = typename board_detail::MaskFor<CELLS>::Type;
+	using Figure = ::Figure;
+
+private:
+	using Ops = board_detail::MaskOps<Mask>;
+	using Zobrist = board_detail::Zobrist<CELLS>;
+
+	Mask m_Crosses;
+	Mask m_Circles;
+	// cells of the line that won the game, empty while nobody has won
+	Mask m_WinningLine;
+	uint64_t m_Hash;
+	int m_MoveCount;
+	// the cells in the order they were played
+	int16_t m_Moves[CELLS];
+
+public:
+	Board()
+		: m_Crosses(0), m_Circles(0), m_WinningLine(0), m_Hash(0), m_MoveCount(0), m_Moves() {}
+
+	// Put the figure of the side to move into the cell.
+	// Returns false (and changes nothing) if the cell is taken or the game is over.
+	bool Play(int cell)
+	{
+		if (cell < 0 || cell >= CELLS || !IsEmpty(cell) || IsOver())
+			return false;
+
+		Mask& figures = (ToMove() == Figure::Cross) ? m_Crosses : m_Circles;
+		figures |= CellMask(cell);
+		m_Hash ^= ZobristKey(ToMove(), cell) ^ Zobrist::KEYS.side;
+		m_Moves[m_MoveCount++] = static_cast<int16_t>(cell);
+		m_WinningLine = board_detail::WinDetector<W, H, K>::Find(figures, cell);
+		return true;
+	}
+
+	// Take back the last move, there has to be one. Nobody had won before it (Play
+	// refuses moves after a win), so the winning line is just cleared.
+	void Undo()
+	{
+		int cell = m_Moves[--m_MoveCount];
+		Mask& figures = (ToMove() == Figure::Cross) ? m_Crosses : m_Circles;
+		figures &= static_cast<Mask>(~CellMask(cell));
+		m_Hash ^= ZobristKey(ToMove(), cell) ^ Zobrist::KEYS.side;
+		m_WinningLine = Mask(0);
+	}
+
+	// Zobrist hash of the position: the keys of all figures, and the side key with circle to move
+	inline uint64_t Hash() const { return m_Hash; }
+	inline static uint64_t ZobristKey(Figure figure, int cell) { return Zobrist::KEYS.cells[static_cast<int>(figure)][cell]; }
+	inline static uint64_t ZobristSideKey() { return Zobrist::KEYS.side; }
+
+	// the cell played as move ply (counted from 0), and the last one, -1 before the first move
+	inline int MoveAt(int ply) const { return m_Moves[ply]; }
+	inline int LastMove() const { return m_MoveCount == 0 ? -1 : m_Moves[m_MoveCount - 1]; }
+
+	inline static Mask CellMask(int cell) { return Ops::Bit(cell); }
+	inline static Mask FullBoard() { return Ops::Full(CELLS); }
+	inline static int CountCells(const Mask& mask) { return Ops::Count(mask); }
+	// True if the figures hold K in a row anywhere, for code that builds positions without Play
+	inline static bool HasLine(const Mask& figures) { return board_detail::WinDetector<W, H, K>::Any(figures); }
+
+	inline bool IsEmpty(int cell) const { return !Ops::Any((m_Crosses | m_Circles) & CellMask(cell)); }
+	inline bool IsFull() const { return m_MoveCount == CELLS; }
+	inline bool IsOver() const { return Ops::Any(m_WinningLine) || IsFull(); }
+	inline int MoveCount() const { return m_MoveCount; }
+	inline Figure ToMove() const { return m_MoveCount % 2 == 0 ? Figure::Cross : Figure::Circle; }
+
+	Figure Winner() const
+	{
+		if (!Ops::Any(m_WinningLine))
+			return Figure::None;
+		return (m_Crosses & m_WinningLine) == m_WinningLine ? Figure::Cross : Figure::Circle;
+	}
+
+	Figure At(int cell) const
+	{
+		if (Ops::Any(m_Crosses & CellMask(cell)))
+			return Figure::Cross;
+		if (Ops::Any(m_Circles & CellMask(cell)))
+			return Figure::Circle;
+		return Figure::None;
+	}
+
+	inline const Mask& Crosses() const { return m_Crosses; }
+	inline const Mask& Circles() const { return m_Circles; }
+	inline Mask EmptyCells() const { return static_cast<Mask>(~(m_Crosses | m_Circles) & FullBoard()); }
+	inline const Mask& WinningLine() const { return m_WinningLine; }
+	inline bool IsOnWinningLine(int cell) const { return Ops::Any(m_WinningLine & CellMask(cell)); }
+};
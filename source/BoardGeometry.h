@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+
+// Where the cells of a W x H board are in normalized device coordinates ([-1, 1] on both axes).
+// The grid mesh and the hit-testing of clicks are both generated from here,
+// so they always agree with each other and with the board size.
+class BoardGeometry
+{
+private:
+	int m_Width;
+	int m_Height;
+	float m_CellWidth;
+	float m_CellHeight;
+
+public:
+	BoardGeometry(int width, int height)
+		: m_Width(width), m_Height(height), m_CellWidth(2.0f / width), m_CellHeight(2.0f / height) {}
+
+	inline float GetCellWidth() const { return m_CellWidth; }
+	inline float GetCellHeight() const { return m_CellHeight; }
+	// scale of the figures, which were modelled for a cell of the 3x3 board
+	inline float GetFigureScale() const { return (m_CellWidth < m_CellHeight ? m_CellWidth : m_CellHeight) / (2.0f / 3.0f); }
+
+	// center of the cell/square, cell 0 is the top-left one
+	inline float CellCenterX(int cell) const { return -1.0f + (cell % m_Width + 0.5f) * m_CellWidth; }
+	inline float CellCenterY(int cell) const { return 1.0f - (cell / m_Width + 0.5f) * m_CellHeight; }
+
+	// find the cell/square under the point, -1 if the point is outside the grid
+	int CellAt(float x, float y) const
+	{
+		if (x < -1.0f || x >= 1.0f || y <= -1.0f || y > 1.0f)
+			return -1;
+		int column = static_cast<int>((x + 1.0f) / m_CellWidth);
+		int row = static_cast<int>((1.0f - y) / m_CellHeight);
+		if (column >= m_Width || row >= m_Height)
+			return -1;
+		return row * m_Width + column;
+	}
+
+	// lines between the cells, two vertices (x, y, z) per line
+	std::vector<float> GridVertices() const
+	{
+		std::vector<float> vertices;
+		vertices.reserve((m_Width + m_Height - 2) * 6);
+		// vertical
+		for (int column = 1; column < m_Width; column++)
+		{
+			float x = -1.0f + column * m_CellWidth;
+			vertices.insert(vertices.end(), { x, -1.0f, 0.0f, x, 1.0f, 0.0f });
+		}
+		// horizontal
+		for (int row = 1; row < m_Height; row++)
+		{
+			float y = 1.0f - row * m_CellHeight;
+			vertices.insert(vertices.end(), { -1.0f, y, 0.0f, 1.0f, y, 0.0f });
+		}
+		return vertices;
+	}
+};
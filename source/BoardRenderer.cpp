@@ -0,0 +1,154 @@
+#include "BoardRenderer.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+const float BoardRenderer::FIGURE_QUAD[8] = {
+	-1.0f, -1.0f,
+	 1.0f, -1.0f,
+	-1.0f,  1.0f,
+	 1.0f,  1.0f,
+};
+
+// a tinted cell is this quad (3 floats per vertex, like the grid), scaled to the cell
+static const float CELL_QUAD[] = {
+	-1.0f, -1.0f, 0.0f,
+	 1.0f, -1.0f, 0.0f,
+	-1.0f,  1.0f, 0.0f,
+	 1.0f,  1.0f, 0.0f,
+};
+// part of the cell the tint covers, the grid lines stay visible around it
+static const float CELL_COLOR_SCALE = 0.9f;
+
+
+BoardRenderer::BoardRenderer(const BoardGeometry& geometry, int width, int height)
+	: m_Geometry(geometry),
+	m_FrameUniforms(DefaultFrameUniforms()),
+	m_FrameUB(sizeof(FrameUniforms), FRAME_DATA_BINDING),
+	m_Grid(geometry.GridVertices()),
+	m_GridShader("resource/shaders/Basic.shader"),
+	m_GridTransform(1.0f),
+	m_GridVB(m_Grid.data(), static_cast<int>(m_Grid.size() * sizeof(float))),
+	m_GridCache(width, height),
+	m_GridChanged(true),
+	m_CellVB(CELL_QUAD, sizeof(CELL_QUAD)),
+	m_FigureShader("resource/shaders/Piece.shader"),
+	m_QuadVB(FIGURE_QUAD, sizeof(FIGURE_QUAD)),
+	m_FigureInstanceVB(nullptr, 0, GL_DYNAMIC_DRAW),
+	m_FiguresChanged(true)
+{
+	// grid
+	m_GridShader.BindUniformBlock("FrameData", FRAME_DATA_BINDING);
+	m_GridColorUniform = m_GridShader.GetUniform("u_color");
+	m_GridTransformUniform = m_GridShader.GetUniform("translation_matrix");
+	VertexBufferLayout grid_layout;
+	grid_layout.Push<float>(3);  // 3 because we have only one attribute (position vertex)
+	m_GridVA.AddBuffer(m_GridVB, grid_layout);
+	m_CellVA.AddBuffer(m_CellVB, grid_layout);
+
+	// crosses and circles
+	m_FigureShader.BindUniformBlock("FrameData", FRAME_DATA_BINDING);
+	VertexBufferLayout quad_layout;
+	quad_layout.Push<float>(2);
+	// one transform (as 4 columns), palette index and shape per instance
+	VertexBufferLayout instance_layout;
+	for (int column = 0; column < 4; column++)
+		instance_layout.Push<float>(4, 1);
+	instance_layout.Push<float>(1, 1);
+	instance_layout.Push<float>(1, 1);
+	m_FigureVA.AddBuffer(m_QuadVB, quad_layout);
+	m_FigureVA.AddBuffer(m_FigureInstanceVB, instance_layout);
+
+	m_FigureVA.Unbind();
+	m_FigureInstanceVB.Unbind();
+
+	// the figures' edges are blended with what is behind them
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+}
+
+void BoardRenderer::Render(Renderer& renderer, int width, int height, const FrameBuffer* target)
+{
+	m_FrameUB.SetData(&m_FrameUniforms, sizeof(m_FrameUniforms));
+
+	if (m_GridCache.GetWidth() != width || m_GridCache.GetHeight() != height)
+	{
+		m_GridCache.Resize(width, height);
+		m_GridChanged = true;
+	}
+	if (m_GridChanged)
+	{
+		m_GridCache.Bind();
+		renderer.Clear();
+		renderer.Submit({ &m_GridShader, &m_GridVA, GL_LINES, static_cast<int>(m_Grid.size()) / 3, 1, 5.0f,
+			m_GridColorUniform, &m_FrameUniforms.palette[PALETTE_GRID], m_GridTransformUniform, &m_GridTransform });
+		renderer.Flush();
+		m_GridChanged = false;
+	}
+
+	if (target != nullptr)
+		target->Bind();
+	else
+	{
+		m_GridCache.Unbind();
+		GLCall(glViewport(0, 0, width, height));
+	}
+	renderer.Clear();
+	m_GridCache.BlitTo(target, width, height);
+
+	// tinted cells, one draw each with the grid's shader and their own color
+	for (const CellColor& cell : m_CellColors)
+	{
+		if (cell.color.a > 0.0f)
+			renderer.Submit({ &m_GridShader, &m_CellVA, GL_TRIANGLE_STRIP, 4, 1, 0.0f,
+				m_GridColorUniform, &cell.color, m_GridTransformUniform, &cell.transform });
+	}
+
+	// draw all currently existing figures in one call
+	if (m_FiguresChanged)
+	{
+		m_FigureInstanceVB.SetData(m_Figures.data(), static_cast<int>(m_Figures.size() * sizeof(FigureInstance)));
+		m_FiguresChanged = false;
+	}
+	renderer.Submit({ &m_FigureShader, &m_FigureVA, GL_TRIANGLE_STRIP, 4,
+		static_cast<int>(m_Figures.size()), 0.0f, Uniform(), nullptr, Uniform(), nullptr });
+	renderer.Flush();
+}
+
+FrameUniforms BoardRenderer::DefaultFrameUniforms()
+{
+	FrameUniforms uniforms;
+	uniforms.view = glm::mat4(1.0f);
+	uniforms.palette[PALETTE_GRID] = glm::vec4(0.05f, 0.45f, 0.35f, 1.0f);
+	uniforms.palette[PALETTE_CROSS] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	uniforms.palette[PALETTE_CIRCLE] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	uniforms.palette[PALETTE_WINNING] = glm::vec4(1.0f, 0.7f, 0.8f, 1.0f);
+	return uniforms;
+}
+
+glm::mat4 BoardRenderer::FigureTransform(const BoardGeometry& geometry, int cell)
+{
+	glm::vec3 center(geometry.CellCenterX(cell), geometry.CellCenterY(cell), 0.0f);
+	glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), center);
+	return glm::scale(translation_matrix, glm::vec3(geometry.GetFigureScale()));
+}
+
+void BoardRenderer::SetCellColor(int cell, const glm::vec4& color)
+{
+	if (cell >= static_cast<int>(m_CellColors.size()))
+		m_CellColors.resize(cell + 1, { glm::mat4(1.0f), glm::vec4(0.0f) });
+	glm::vec3 center(m_Geometry.CellCenterX(cell), m_Geometry.CellCenterY(cell), 0.0f);
+	glm::vec3 scale(m_Geometry.GetCellWidth() * 0.5f * CELL_COLOR_SCALE, m_Geometry.GetCellHeight() * 0.5f * CELL_COLOR_SCALE, 1.0f);
+	m_CellColors[cell] = { glm::scale(glm::translate(glm::mat4(1.0f), center), scale), color };
+}
+
+void BoardRenderer::ClearCellColors()
+{
+	m_CellColors.clear();
+}
+
+void BoardRenderer::AddFigure(int cell, bool cross, bool winning)
+{
+	float palette = static_cast<float>(winning ? PALETTE_WINNING : (cross ? PALETTE_CROSS : PALETTE_CIRCLE));
+	m_Figures.push_back({ FigureTransform(m_Geometry, cell), palette, cross ? 0.0f : 1.0f });
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Renderer.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "FrameBuffer.h"
+#include "UniformBuffer.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+
+
+// layout of the per-instance attributes of Piece.shader
+struct FigureInstance
+{
+	glm::mat4 transform;
+	float palette;  // index into FrameUniforms::palette
+	float shape;    // 0 cross, 1 circle
+};
+
+// per-frame data of the FrameData block in the shaders, std140: mat4 and vec4 arrays need no padding
+struct FrameUniforms
+{
+	glm::mat4 view;
+	glm::vec4 palette[4];
+};
+static_assert(sizeof(FrameUniforms) == 128, "FrameUniforms must match the std140 layout of FrameData");
+enum Palette { PALETTE_GRID, PALETTE_CROSS, PALETTE_CIRCLE, PALETTE_WINNING };
+
+// a tinted cell, drawn with the grid's shader
+struct CellColor
+{
+	glm::mat4 transform;
+	glm::vec4 color;  // alpha 0: not drawn
+};
+
+
+// Draws a board: the grid (rendered once into a cache) and every figure in one instanced call.
+// Shared by the game and the headless render benchmark, needs a current GL context.
+class BoardRenderer
+{
+public:
+	static const unsigned int FRAME_DATA_BINDING = 0;
+	// every figure is this quad (GL_TRIANGLE_STRIP, 2 floats per vertex), Piece.shader cuts the cross or the circle out of it
+	static const float FIGURE_QUAD[8];
+
+private:
+	BoardGeometry m_Geometry;
+	FrameUniforms m_FrameUniforms;
+	UniformBuffer m_FrameUB;
+
+	std::vector<float> m_Grid;
+	Shader m_GridShader;
+	Uniform m_GridColorUniform;
+	Uniform m_GridTransformUniform;
+	glm::mat4 m_GridTransform;
+	VertexBuffer m_GridVB;
+	VertexArray m_GridVA;
+	FrameBuffer m_GridCache;
+	bool m_GridChanged;
+
+	VertexBuffer m_CellVB;
+	VertexArray m_CellVA;
+	std::vector<CellColor> m_CellColors;
+
+	Shader m_FigureShader;
+	VertexBuffer m_QuadVB;
+	VertexBuffer m_FigureInstanceVB;
+	VertexArray m_FigureVA;
+	std::vector<FigureInstance> m_Figures;
+	bool m_FiguresChanged;
+
+public:
+	// width and height: size of the render target in pixels
+	BoardRenderer(const BoardGeometry& geometry, int width, int height);
+
+	// take the figures from the board, uploaded with the next Render
+	template<typename BoardType>
+	void SetBoard(const BoardType& board);
+
+	// Draw into target, or into the window when target is nullptr. Issues everything
+	// through the renderer and flushes it; call Renderer::BeginFrame before.
+	void Render(Renderer& renderer, int width, int height, const FrameBuffer* target = nullptr);
+
+	inline const FrameUniforms& GetFrameUniforms() const { return m_FrameUniforms; }
+	// identity view and the game's colors, shared with the tournament view
+	static FrameUniforms DefaultFrameUniforms();
+
+	// tint the cell under the figures (for instance with the analysis of the move there), until cleared
+	void SetCellColor(int cell, const glm::vec4& color);
+	void ClearCellColors();
+
+	// place the figure quad of Piece.shader on the cell
+	static glm::mat4 FigureTransform(const BoardGeometry& geometry, int cell);
+
+private:
+	void AddFigure(int cell, bool cross, bool winning);
+};
+
+
+template<typename BoardType>
+void BoardRenderer::SetBoard(const BoardType& board)
+{
+	m_Figures.clear();
+	for (int cell = 0; cell < BoardType::CELLS; cell++)
+	{
+		Figure figure = board.At(cell);
+		if (figure != Figure::None)
+			AddFigure(cell, figure == Figure::Cross, board.IsOnWinningLine(cell));
+	}
+	m_FiguresChanged = true;
+}
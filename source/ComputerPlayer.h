@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Board.h"
+#include "Solver.h"
+#include "OpeningBook.h"
+#include "Mcts.h"
+
+
+namespace computer_detail
+{
+	// 3x3 and smaller: book first, perfect play by search if the position isn't there.
+	template<typename BoardType, bool EXACT = (BoardType::CELLS <= 9)>
+	class Engine
+	{
+	private:
+		Solver<BoardType> m_Solver;
+		OpeningBook m_Book;
+
+	public:
+		bool LoadBook(const std::string& filepath) { return m_Book.Load(filepath); }
+
+		int ChooseMove(const BoardType& board, const std::atomic<bool>&)
+		{
+			int cell = m_Book.BestMove(board);
+			if (cell != -1)
+				return cell;
+
+			m_Solver.ResetStatistics();
+			cell = m_Solver.BestMove(board);
+			const auto& statistics = m_Solver.GetStatistics();
+			std::cout << "Solver: " << statistics.nodes << " nodes, " << statistics.probes << " table probes, "
+				<< statistics.HitRate() * 100.0 << "% hits" << std::endl;
+			return cell;
+		}
+	};
+
+	// Bigger boards: MCTS on all cores.
+	template<typename BoardType>
+	class Engine<BoardType, false>
+	{
+	private:
+		Mcts<BoardType> m_Mcts;
+
+	public:
+		bool LoadBook(const std::string&) { return false; }
+
+		int ChooseMove(const BoardType& board, const std::atomic<bool>& stop)
+		{
+			int cell = m_Mcts.Search(board, &stop);
+			const auto& statistics = m_Mcts.GetStatistics();
+			for (size_t i = 0; i < statistics.size(); i++)
+			{
+				std::cout << "MCTS thread " << i << ": " << statistics[i].playouts << " playouts, "
+					<< static_cast<long long>(statistics[i].PlayoutsPerSecond()) << " playouts/s" << std::endl;
+			}
+			return cell;
+		}
+	};
+}
+
+
+// Computer opponent that thinks on its own thread, so the render loop never waits for it.
+// Start() hands it a position, the render loop asks for the answer with TakeMove() every frame.
+template<typename BoardType>
+class ComputerPlayer
+{
+private:
+	computer_detail::Engine<BoardType> m_Engine;
+	std::thread m_Thread;
+	std::atomic<bool> m_Stop;
+	std::atomic<bool> m_Ready;
+	int m_Move;
+	std::function<void()> m_OnReady;
+
+public:
+	ComputerPlayer()
+		: m_Stop(false), m_Ready(false), m_Move(-1) {}
+	~ComputerPlayer() { Cancel(); }
+
+	ComputerPlayer(const ComputerPlayer&) = delete;
+	ComputerPlayer& operator=(const ComputerPlayer&) = delete;
+
+	bool LoadBook(const std::string& filepath) { return m_Engine.LoadBook(filepath); }
+	// called on the computer's thread when a move is ready (for instance to wake up a sleeping render loop)
+	void SetOnReady(std::function<void()> on_ready) { m_OnReady = on_ready; }
+
+	// start thinking about the position (a previous search is dropped)
+	void Start(const BoardType& board)
+	{
+		Cancel();
+		m_Stop = false;
+		m_Ready = false;
+		m_Thread = std::thread([this, board]()
+		{
+			m_Move = m_Engine.ChooseMove(board, m_Stop);
+			m_Ready.store(true, std::memory_order_release);
+			if (m_OnReady)
+				m_OnReady();
+		});
+	}
+
+	// stop thinking and forget the answer (for instance when the board is reset)
+	void Cancel()
+	{
+		m_Stop = true;
+		if (m_Thread.joinable())
+			m_Thread.join();
+		m_Ready = false;
+	}
+
+	// true from Start until TakeMove has taken the answer (or Cancel dropped it), the position is the computer's until then
+	inline bool IsThinking() const { return m_Thread.joinable(); }
+
+	// The chosen cell once the search has finished (only once per Start), -1 while still thinking.
+	int TakeMove()
+	{
+		if (!m_Ready.load(std::memory_order_acquire))
+			return -1;
+		m_Thread.join();
+		m_Ready = false;
+		return m_Move;
+	}
+};
@@ -0,0 +1,91 @@
+#include "FrameBuffer.h"
+#include "Renderer.h"
+
+#include <utility>
+
+FrameBuffer::FrameBuffer(int width, int height)
+	: m_RendererID(0), m_ColorAttachment(0), m_Width(width), m_Height(height)
+{
+	Create();
+}
+
+FrameBuffer::~FrameBuffer()
+{
+	Destroy();
+}
+
+FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_ColorAttachment(other.m_ColorAttachment), m_Width(other.m_Width), m_Height(other.m_Height)
+{
+	other.m_RendererID = 0;
+	other.m_ColorAttachment = 0;
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_ColorAttachment, other.m_ColorAttachment);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	return *this;
+}
+
+void FrameBuffer::Resize(int width, int height)
+{
+	if (width == m_Width && height == m_Height)
+		return;
+	Destroy();
+	m_Width = width;
+	m_Height = height;
+	Create();
+}
+
+void FrameBuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void FrameBuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::BlitTo(const FrameBuffer* target, int width, int height) const
+{
+	unsigned int target_id = target != nullptr ? target->m_RendererID : 0;
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_id));
+	GLCall(glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, target_id));
+}
+
+void FrameBuffer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.resize(static_cast<size_t>(m_Width) * m_Height * 4);
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::Create()
+{
+	// a render buffer is enough, the contents are only ever blitted
+	GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_Width, m_Height));
+
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "WARNING: Frame buffer " << m_Width << "x" << m_Height << " is incomplete" << std::endl;
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void FrameBuffer::Destroy()
+{
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+	GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+}
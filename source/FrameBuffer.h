@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+// Offscreen render target with a single color attachment.
+// Used to keep things that rarely change (like the grid) rendered, so a frame only copies them.
+class FrameBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	int m_Width;
+	int m_Height;
+
+public:
+	FrameBuffer(int width, int height);
+	~FrameBuffer();
+
+	FrameBuffer(FrameBuffer&& other) noexcept;
+	FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+	FrameBuffer(const FrameBuffer&) = delete;
+	FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+	// reallocates the attachment, the contents are lost
+	void Resize(int width, int height);
+
+	// render into the frame buffer, the viewport is set to its size
+	void Bind() const;
+	// render to the window again
+	void Unbind() const;
+
+	// copy the contents over the whole of target (the window if nullptr) of the given size,
+	// leaves target bound
+	void BlitTo(const FrameBuffer* target, int width, int height) const;
+	// read the pixels back as RGBA, bottom row first
+	void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+
+private:
+	void Create();
+	void Destroy();
+};
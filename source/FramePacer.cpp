@@ -0,0 +1,93 @@
+#include "FramePacer.h"
+#include "Renderer.h"
+#include "GLSync.h"
+
+#include <algorithm>
+
+static const char* MODE_NAMES[FramePacer::PACING_COUNT] = { "off", "fence", "finish" };
+
+
+FramePacer::FramePacer()
+	: m_Mode(PACING_OFF), m_Fence(nullptr), m_InputPending(false)
+{
+	m_Latencies.reserve(1024);
+}
+
+FramePacer::~FramePacer()
+{
+	if (m_Fence != nullptr)
+	{
+		GLCall(glDeleteSync(m_Fence));
+	}
+}
+
+void FramePacer::SetMode(Mode mode)
+{
+	m_Mode = mode;
+	if (m_Mode != PACING_FENCE && m_Fence != nullptr)
+	{
+		GLCall(glDeleteSync(m_Fence));
+		m_Fence = nullptr;
+	}
+}
+
+const char* FramePacer::ModeName(Mode mode)
+{
+	return MODE_NAMES[mode];
+}
+
+void FramePacer::WaitForGpu()
+{
+	WaitFence(m_Fence);
+}
+
+void FramePacer::AfterSwap()
+{
+	if (m_Mode == PACING_FINISH)
+	{
+		GLCall(glFinish());
+	}
+	else if (m_Mode == PACING_FENCE)
+	{
+		if (m_Fence != nullptr)
+		{
+			GLCall(glDeleteSync(m_Fence));
+		}
+		GLCall(m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	}
+
+	if (m_InputPending)
+	{
+		m_Latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - m_InputTime).count());
+		m_InputPending = false;
+	}
+}
+
+void FramePacer::MarkInput()
+{
+	if (m_InputPending)
+		return;
+	m_InputPending = true;
+	m_InputTime = Clock::now();
+}
+
+FramePacer::LatencyReport FramePacer::GetLatency() const
+{
+	LatencyReport report;
+	if (m_Latencies.empty())
+		return report;
+	std::vector<double> sorted = m_Latencies;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](double p) { return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))]; };
+	report.samples = sorted.size();
+	report.p50_ms = percentile(0.50);
+	report.p99_ms = percentile(0.99);
+	report.max_ms = sorted.back();
+	return report;
+}
+
+void FramePacer::ResetLatency()
+{
+	m_Latencies.clear();
+	m_InputPending = false;
+}
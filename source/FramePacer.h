@@ -0,0 +1,66 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+
+// Low-latency frame pacing and input-to-screen latency measurement.
+//
+// Drivers let the CPU queue up a few frames ahead of the GPU, and every queued frame is a
+// frame of delay between a click and the picture that shows it. The pacer keeps the queue
+// short: PACING_FENCE puts a fence behind every swap and waits for it before the next frame
+// samples its input (at most one frame in flight), PACING_FINISH calls glFinish right after
+// the swap (none). Input should then be sampled after WaitForGpu, just before rendering.
+//
+// Latency is measured from an input that changes the picture (MarkInput) to the return of
+// the first swap after it, after glFinish in PACING_FINISH. The display's scanout comes on
+// top of that and isn't visible from here.
+class FramePacer
+{
+public:
+	enum Mode { PACING_OFF, PACING_FENCE, PACING_FINISH, PACING_COUNT };
+
+	struct LatencyReport
+	{
+		size_t samples = 0;
+		double p50_ms = 0.0;
+		double p99_ms = 0.0;
+		double max_ms = 0.0;
+	};
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Mode m_Mode;
+	GLsync m_Fence;
+	// the oldest input that isn't on the screen yet
+	bool m_InputPending;
+	Clock::time_point m_InputTime;
+	std::vector<double> m_Latencies;
+
+public:
+	FramePacer();
+	~FramePacer();
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	void SetMode(Mode mode);
+	inline Mode GetMode() const { return m_Mode; }
+	static const char* ModeName(Mode mode);
+
+	// Before sampling the input of a frame: blocks until the GPU has finished the last frame (PACING_FENCE).
+	void WaitForGpu();
+	// Right after SwapBuffers: fence or glFinish, and the latency of the input shown by this frame.
+	void AfterSwap();
+
+	// An input that changes the picture happened now, later inputs before the next swap count from this one.
+	void MarkInput();
+
+	// p50/p99 of the latencies measured since the last reset
+	LatencyReport GetLatency() const;
+	inline size_t GetLatencySamples() const { return m_Latencies.size(); }
+	void ResetLatency();
+};
@@ -0,0 +1,79 @@
+#include "GLDebug.h"
+#include "GLFeatures.h"
+
+#include <iostream>
+
+GLDebug::CallSite GLDebug::s_CallSite;
+unsigned int GLDebug::s_Frame = 0;
+bool GLDebug::s_SampledFrame = true;
+
+
+// iterate through all errors to clear it
+void GLClearError()
+{
+	// GL_NO_ERROR is guaranteed to be 0
+	while (glGetError() != GL_NO_ERROR);
+}
+
+bool GLCallLog(const char* function, const char* file, int line)
+{
+	while (GLenum error = glGetError())
+	{
+		std::cout << "[ERROR]:" << error << " | " << function << ", " << file << " | " << line << std::endl;
+		// error has been occured
+		return false;
+	}
+	// no errors has been spoted
+	return true;
+}
+
+
+bool GLDebug::EnableDebugOutput(bool synchronous)
+{
+#if GL_FEATURE_DEBUG_OUTPUT
+	if (!GLFeatures::HasDebugOutput())
+		return false;
+	// without a debug context the driver may send few messages or none at all
+	int flags = 0;
+	GLCall(glGetIntegerv(GL_CONTEXT_FLAGS, &flags));
+	if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+		return false;
+	GLCall(glEnable(GL_DEBUG_OUTPUT));
+	if (synchronous)
+	{
+		GLCall(glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS));
+	}
+	GLCall(glDebugMessageCallback(MessageCallback, nullptr));
+	// notifications (buffer placement and the like) are only noise
+	GLCall(glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE));
+	return true;
+#else
+	// glad was generated without it, glGetError is all there is
+	return false;
+#endif
+}
+
+void GLDebug::BeginFrame()
+{
+	s_Frame++;
+	s_SampledFrame = s_Frame % GL_CHECK_SAMPLE_INTERVAL == 0;
+}
+
+#if GL_FEATURE_DEBUG_OUTPUT
+void APIENTRY GLDebug::MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei length, const GLchar* message, const void* user)
+{
+	const char* severity_name = severity == GL_DEBUG_SEVERITY_HIGH ? "high"
+		: (severity == GL_DEBUG_SEVERITY_MEDIUM ? "medium" : "low");
+	const CallSite& call_site = GetCallSite();
+	std::cout << "[GL " << (type == GL_DEBUG_TYPE_ERROR ? "ERROR" : "DEBUG") << ", " << severity_name << "]:" << id << " " << message;
+	// GL_CHECK_OFF doesn't record where the calls come from
+	if (call_site.line != 0)
+		std::cout << " | " << call_site.function << ", " << call_site.file << " | " << call_site.line;
+	std::cout << std::endl;
+#if GL_CHECK_MODE == GL_CHECK_FULL
+	if (type == GL_DEBUG_TYPE_ERROR)
+		DEBUG_BREAK();
+#endif
+}
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "GLFeatures.h"
+
+
+// GL error checking, chosen at build time with -DGL_CHECK_MODE=...
+//   GL_CHECK_OFF      GLCall(x) is x, nothing is checked per call (default with NDEBUG)
+//   GL_CHECK_SAMPLED  glGetError around every call, but only in every GL_CHECK_SAMPLE_INTERVAL-th frame
+//   GL_CHECK_FULL     glGetError around every call (default without NDEBUG)
+// glGetError can stall until the driver has caught up, GLDebug::EnableDebugOutput reports
+// errors through a GL_KHR_debug callback instead, which costs nothing per call. Its messages
+// name the GLCall they came from in the checked modes; GL_CHECK_OFF doesn't record call sites.
+#define GL_CHECK_OFF 0
+#define GL_CHECK_SAMPLED 1
+#define GL_CHECK_FULL 2
+
+#ifndef GL_CHECK_MODE
+	#ifdef NDEBUG
+		#define GL_CHECK_MODE GL_CHECK_OFF
+	#else
+		#define GL_CHECK_MODE GL_CHECK_FULL
+	#endif
+#endif
+
+#ifndef GL_CHECK_SAMPLE_INTERVAL
+	#define GL_CHECK_SAMPLE_INTERVAL 60
+#endif
+
+// stop in the debugger
+#if defined(_MSC_VER)
+	#define DEBUG_BREAK() __debugbreak()
+#else
+	#include <csignal>
+	#define DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// find errors
+// In the checked modes GLCall also remembers where it was called from (plain stores, no GL
+// call), so the debug output callback can say which call went wrong.
+#if GL_CHECK_MODE == GL_CHECK_FULL
+	#define GLCall(x) GLDebug::SetCallSite(#x, __FILE__, __LINE__);\
+		GLClearError();\
+		x;\
+		ASSERT(GLCallLog(#x, __FILE__, __LINE__))  // # to convert into a string
+#elif GL_CHECK_MODE == GL_CHECK_SAMPLED
+	#define GLCall(x) GLDebug::SetCallSite(#x, __FILE__, __LINE__);\
+		if (GLDebug::IsSampledFrame()) GLClearError();\
+		x;\
+		ASSERT(!GLDebug::IsSampledFrame() || GLCallLog(#x, __FILE__, __LINE__))
+#else
+	#define GLCall(x) x
+#endif
+
+
+void GLClearError();
+bool GLCallLog(const char* function, const char* file, int line);
+
+class GLDebug
+{
+public:
+	struct CallSite
+	{
+		const char* function = "";
+		const char* file = "";
+		int line = 0;
+	};
+
+private:
+	static CallSite s_CallSite;
+	static unsigned int s_Frame;
+	static bool s_SampledFrame;
+
+public:
+	// Install the GL_KHR_debug message callback, false if the context has no debug output, isn't
+	// a debug context (GLFW_OPENGL_DEBUG_CONTEXT) or glad was generated without it (see GLFeatures.h).
+	// Synchronous output is slower but reports in the offending call, so the call site is exact;
+	// asynchronous output names the last GLCall before the message arrived.
+	static bool EnableDebugOutput(bool synchronous);
+
+	// advance the frame counter of the sampled mode
+	static void BeginFrame();
+
+	inline static void SetCallSite(const char* function, const char* file, int line)
+	{
+		s_CallSite.function = function;
+		s_CallSite.file = file;
+		s_CallSite.line = line;
+	}
+	inline static const CallSite& GetCallSite() { return s_CallSite; }
+	inline static bool IsSampledFrame() { return s_SampledFrame; }
+
+private:
+#if GL_FEATURE_DEBUG_OUTPUT
+	static void APIENTRY MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+		GLsizei length, const GLchar* message, const void* user);
+#endif
+};
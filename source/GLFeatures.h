@@ -0,0 +1,71 @@
+#pragma once
+
+#include "glad/glad.h"
+
+
+// GL features past the 3.3 core profile that the engine uses when it can. Each one is compiled
+// in only if the glad in use was generated with it (its GL_VERSION_x_y or extension macro is
+// defined, see the README), and used only if the context offers it at run time. With a plain
+// 3.3 core glad they are all off and the callers take their 3.3 path.
+#if defined(GL_VERSION_4_3) || defined(GL_KHR_debug)
+	#define GL_FEATURE_DEBUG_OUTPUT 1
+#else
+	#define GL_FEATURE_DEBUG_OUTPUT 0
+#endif
+
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+	#define GL_FEATURE_PROGRAM_BINARY 1
+#else
+	#define GL_FEATURE_PROGRAM_BINARY 0
+#endif
+
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+	#define GL_FEATURE_BUFFER_STORAGE 1
+#else
+	#define GL_FEATURE_BUFFER_STORAGE 0
+#endif
+
+
+// Whether the current context has the feature, false if it isn't compiled in. Needs gladLoadGLLoader first.
+class GLFeatures
+{
+public:
+	// glDebugMessageCallback (GL 4.3 or KHR_debug)
+	static bool HasDebugOutput()
+	{
+		bool has = false;
+#ifdef GL_VERSION_4_3
+		has = has || GLAD_GL_VERSION_4_3;
+#endif
+#ifdef GL_KHR_debug
+		has = has || GLAD_GL_KHR_debug;
+#endif
+		return has;
+	}
+
+	// glGetProgramBinary / glProgramBinary (GL 4.1 or ARB_get_program_binary)
+	static bool HasProgramBinary()
+	{
+		bool has = false;
+#ifdef GL_VERSION_4_1
+		has = has || GLAD_GL_VERSION_4_1;
+#endif
+#ifdef GL_ARB_get_program_binary
+		has = has || GLAD_GL_ARB_get_program_binary;
+#endif
+		return has;
+	}
+
+	// glBufferStorage with persistent mapping (GL 4.4 or ARB_buffer_storage)
+	static bool HasBufferStorage()
+	{
+		bool has = false;
+#ifdef GL_VERSION_4_4
+		has = has || GLAD_GL_VERSION_4_4;
+#endif
+#ifdef GL_ARB_buffer_storage
+		has = has || GLAD_GL_ARB_buffer_storage;
+#endif
+		return has;
+	}
+};
@@ -0,0 +1,86 @@
+#include "GLState.h"
+#include "Renderer.h"
+
+// 0 is a valid binding (nothing bound), so "unknown" is the largest id
+static const unsigned int UNKNOWN = ~0u;
+
+unsigned int GLState::s_Program = UNKNOWN;
+unsigned int GLState::s_VertexArray = UNKNOWN;
+unsigned int GLState::s_ArrayBuffer = UNKNOWN;
+float GLState::s_LineWidth = -1.0f;
+GLState::Counters GLState::s_Counters;
+
+
+void GLState::UseProgram(unsigned int program)
+{
+	if (s_Program == program)
+	{
+		s_Counters.elided++;
+		return;
+	}
+	GLCall(glUseProgram(program));
+	s_Program = program;
+	s_Counters.issued++;
+}
+
+void GLState::BindVertexArray(unsigned int vertex_array)
+{
+	if (s_VertexArray == vertex_array)
+	{
+		s_Counters.elided++;
+		return;
+	}
+	GLCall(glBindVertexArray(vertex_array));
+	s_VertexArray = vertex_array;
+	s_Counters.issued++;
+}
+
+void GLState::BindArrayBuffer(unsigned int buffer)
+{
+	if (s_ArrayBuffer == buffer)
+	{
+		s_Counters.elided++;
+		return;
+	}
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+	s_ArrayBuffer = buffer;
+	s_Counters.issued++;
+}
+
+void GLState::LineWidth(float width)
+{
+	if (s_LineWidth == width)
+	{
+		s_Counters.elided++;
+		return;
+	}
+	GLCall(glLineWidth(width));
+	s_LineWidth = width;
+	s_Counters.issued++;
+}
+
+void GLState::ProgramDeleted(unsigned int program)
+{
+	if (s_Program == program)
+		s_Program = UNKNOWN;
+}
+
+void GLState::VertexArrayDeleted(unsigned int vertex_array)
+{
+	if (s_VertexArray == vertex_array)
+		s_VertexArray = 0;
+}
+
+void GLState::ArrayBufferDeleted(unsigned int buffer)
+{
+	if (s_ArrayBuffer == buffer)
+		s_ArrayBuffer = 0;
+}
+
+void GLState::Invalidate()
+{
+	s_Program = UNKNOWN;
+	s_VertexArray = UNKNOWN;
+	s_ArrayBuffer = UNKNOWN;
+	s_LineWidth = -1.0f;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+
+// Shadow copy of the GL state that the renderer changes most often.
+// All binds go through here and are skipped when the object is already bound.
+// There is one GL context, so the cache is global; call Invalidate() after
+// changing these bindings with raw GL calls.
+class GLState
+{
+public:
+	struct Counters
+	{
+		unsigned int issued = 0;      // state changes sent to GL
+		unsigned int elided = 0;      // state changes skipped, GL already had them
+		unsigned int draw_calls = 0;
+		unsigned int vertices = 0;         // vertices drawn, times the instances
+		unsigned int uniform_uploads = 0;  // glUniform* calls and uniform buffer updates
+	};
+
+private:
+	static unsigned int s_Program;
+	static unsigned int s_VertexArray;
+	static unsigned int s_ArrayBuffer;
+	static float s_LineWidth;
+	static Counters s_Counters;
+
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertex_array);
+	static void BindArrayBuffer(unsigned int buffer);
+	static void LineWidth(float width);
+
+	// GL unbinds deleted objects, so must the cache
+	static void ProgramDeleted(unsigned int program);
+	static void VertexArrayDeleted(unsigned int vertex_array);
+	static void ArrayBufferDeleted(unsigned int buffer);
+
+	static void Invalidate();
+
+	inline static void CountDrawCall(unsigned int vertices)
+	{
+		s_Counters.draw_calls++;
+		s_Counters.vertices += vertices;
+	}
+	inline static void CountUniformUpload() { s_Counters.uniform_uploads++; }
+	inline static const Counters& GetCounters() { return s_Counters; }
+	inline static void ResetCounters() { s_Counters = Counters(); }
+};
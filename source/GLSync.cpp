@@ -0,0 +1,19 @@
+#include "GLSync.h"
+#include "GLDebug.h"
+
+void WaitFence(GLsync& fence)
+{
+	if (fence == nullptr)
+		return;
+	// flush once so the fence is sure to be signaled, then wait as long as it takes
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLCall(GLenum result = glClientWaitSync(fence, flags, 1000000000));
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+			break;
+		flags = 0;
+	}
+	GLCall(glDeleteSync(fence));
+	fence = nullptr;
+}
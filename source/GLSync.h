@@ -0,0 +1,8 @@
+#pragma once
+
+#include "glad/glad.h"
+
+
+// Block until the GPU has passed the fence, however long that takes, then delete it and set
+// it to nullptr. Nothing to do for nullptr.
+void WaitFence(GLsync& fence);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "Board.h"
+
+
+// The classic game: 3x3 board, 3 in a row.
+using GameState = Board<3, 3, 3>;
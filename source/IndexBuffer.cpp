@@ -1,6 +1,8 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
 
+#include <utility>
+
 // Index buffer allows us to reuse existing vertices.
 IndexBuffer::IndexBuffer(const void* data, int count)
 {
@@ -14,6 +16,18 @@ IndexBuffer::~IndexBuffer()
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
+}
+
 void IndexBuffer::Bind() const
 {
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
@@ -10,6 +10,11 @@ public:
 	IndexBuffer(const void* data, int count);
 	~IndexBuffer();
 
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 };
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+// Bounded queue for many producer threads and one consumer, without locks: a ring of slots,
+// each with a sequence number that says whose turn it is. A producer claims the next slot
+// by advancing the head with a compare-and-swap, writes the value and then releases the slot
+// to the consumer by bumping its sequence; the consumer does the reverse. Nobody ever waits
+// for anybody: Push fails when the ring is full, Pop fails when nothing is ready.
+template<typename T>
+class LockFreeQueue
+{
+private:
+	struct Slot
+	{
+		// position + 1 once the value of position is written, position + capacity once it is read
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> m_Slots;
+	size_t m_Mask;
+	// padded, so the producers moving the head don't keep taking the cache line of the consumer's tail
+	char m_Padding0[64];
+	std::atomic<size_t> m_Head;
+	char m_Padding1[64];
+	std::atomic<size_t> m_Tail;
+
+public:
+	// capacity is rounded up to a power of two
+	explicit LockFreeQueue(size_t capacity)
+		: m_Head(0), m_Tail(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size *= 2;
+		m_Slots.reset(new Slot[size]);
+		m_Mask = size - 1;
+		for (size_t i = 0; i < size; i++)
+			m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	LockFreeQueue(const LockFreeQueue&) = delete;
+	LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+	inline size_t GetCapacity() const { return m_Mask + 1; }
+
+	// From any thread, false if the queue is full.
+	bool Push(const T& value)
+	{
+		size_t position = m_Head.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Slot& slot = m_Slots[position & m_Mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				// the slot is free, claim it (a failed exchange reloads position)
+				if (m_Head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					slot.value = value;
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+				return false;
+			else
+				position = m_Head.load(std::memory_order_relaxed);
+		}
+	}
+
+	// From the consumer thread only, false if nothing is ready.
+	bool Pop(T& value)
+	{
+		size_t position = m_Tail.load(std::memory_order_relaxed);
+		Slot& slot = m_Slots[position & m_Mask];
+		if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+			return false;
+		value = slot.value;
+		slot.sequence.store(position + m_Mask + 1, std::memory_order_release);
+		m_Tail.store(position + 1, std::memory_order_relaxed);
+		return true;
+	}
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+
+// Read-only view of a whole file mapped into memory (mmap / MapViewOfFile).
+// Nothing is read or copied up front, pages are loaded by the OS on first touch.
+class MappedFile
+{
+private:
+	const void* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// returns false if the file can't be opened or is empty
+	bool Open(const std::string& filepath);
+	void Close();
+
+	inline const void* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+	inline bool IsOpen() const { return m_Data != nullptr; }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Board.h"
+
+
+// Binary protocol of tools/MatchServer.cpp (little-endian): every message, both ways, is one
+// MatchMessage. A client hosts any number of games over one connection; each game names the
+// client's seat by the tag the client gave with MSG_CREATE or MSG_JOIN, and every message the
+// server sends about the game carries that tag back, so clients can index their games by it.
+struct MatchMessage
+{
+	uint8_t type;    // MatchMessageType
+	uint8_t status;  // MSG_CREATE: MatchMode, moves: MatchOutcome after the move, MSG_ERROR: MatchError
+	uint16_t cell;
+	uint32_t game;   // id handed out by the server with the reply to MSG_CREATE
+	uint32_t tag;
+};
+static_assert(sizeof(MatchMessage) == 12, "MatchMessage must match the wire layout");
+
+enum MatchMessageType : uint8_t
+{
+	// requests, answered with the same type | MSG_REPLY or with MSG_ERROR
+	MSG_CREATE = 1,         // a new game, the creator plays crosses. Reply: game
+	MSG_JOIN = 2,           // take the circle seat of a MODE_PLAYERS game
+	MSG_MOVE = 3,           // put the figure of the side to move into cell. Reply: cell and outcome
+	MSG_RESET = 4,          // clear the board for a new game in the same session, the reply goes to both players
+	MSG_LEAVE = 5,          // end the session
+	// sent by the server on its own
+	MSG_OPPONENT_MOVE = 6,  // the opponent (or the bot) put a figure into cell
+	MSG_OPPONENT_JOINED = 7,
+	MSG_CLOSED = 8,         // the opponent left or disconnected, the session is gone
+	MSG_ERROR = 9,
+	MSG_REPLY = 0x80,
+};
+
+enum MatchMode : uint8_t
+{
+	MODE_BOT = 0,      // the server answers every move with a random one for circles
+	MODE_LOCAL = 1,    // the creator plays both sides
+	MODE_PLAYERS = 2,  // circles wait for another client to MSG_JOIN
+};
+
+enum MatchOutcome : uint8_t
+{
+	OUTCOME_PLAYING = 0,
+	OUTCOME_CROSS_WINS = 1,
+	OUTCOME_CIRCLE_WINS = 2,
+	OUTCOME_DRAW = 3,
+};
+
+enum MatchError : uint8_t
+{
+	ERROR_BAD_MESSAGE = 1,
+	ERROR_NO_GAME = 2,        // no such game, or the client doesn't play in it
+	ERROR_SERVER_FULL = 3,
+	ERROR_SEAT_TAKEN = 4,
+	ERROR_NO_OPPONENT = 5,
+	ERROR_NOT_YOUR_TURN = 6,
+	ERROR_ILLEGAL_MOVE = 7,   // the board refused the cell
+};
+
+
+template<int W, int H, int K>
+MatchOutcome OutcomeOf(const Board<W, H, K>& board)
+{
+	if (!board.IsOver())
+		return OUTCOME_PLAYING;
+	Figure winner = board.Winner();
+	if (winner == Figure::None)
+		return OUTCOME_DRAW;
+	return winner == Figure::Cross ? OUTCOME_CROSS_WINS : OUTCOME_CIRCLE_WINS;
+}
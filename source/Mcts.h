@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+
+
+// Monte Carlo Tree Search (UCT) for boards too big to search exhaustively.
+// All threads walk one shared tree (tree parallelism): node statistics are atomics,
+// a thread going down a path adds a virtual loss to it so the others spread out,
+// and every thread allocates the nodes it expands from its own arena.
+template<typename BoardType>
+class Mcts
+{
+public:
+	struct Settings
+	{
+		int threads = 0;            // 0: one per hardware thread
+		double seconds = 1.0;       // time budget per move, 0 for no time limit
+		uint64_t playouts = 0;      // playout budget per move (all threads together), 0 for no limit
+		double exploration = 1.4;   // UCT exploration constant
+		int expand_after = 2;       // visits a leaf needs before it gets children
+		uint64_t max_nodes = 1 << 22;
+	};
+
+	struct ThreadStatistics
+	{
+		uint64_t playouts = 0;
+		double seconds = 0.0;
+
+		double PlayoutsPerSecond() const { return seconds > 0.0 ? playouts / seconds : 0.0; }
+	};
+
+private:
+	static const int CELLS = BoardType::CELLS;
+	static const int VIRTUAL_LOSS = 1;
+	enum : int { LEAF = 0, EXPANDING = 1, EXPANDED = 2 };
+
+	struct Node
+	{
+		std::atomic<int> visits;
+		// score of the player who made `move`, in half points (win 2, draw 1, loss 0)
+		std::atomic<int> score;
+		std::atomic<int> state;
+		Node* children;
+		int16_t child_count;
+		int16_t move;
+
+		void Reset(int cell)
+		{
+			visits.store(0, std::memory_order_relaxed);
+			score.store(0, std::memory_order_relaxed);
+			state.store(LEAF, std::memory_order_relaxed);
+			children = nullptr;
+			child_count = 0;
+			move = static_cast<int16_t>(cell);
+		}
+	};
+
+	// Per-thread node pool: big blocks that are reused from one search to the next.
+	class NodeArena
+	{
+	private:
+		static const size_t BLOCK_SIZE = 1 << 14;
+		std::vector<std::unique_ptr<Node[]>> m_Blocks;
+		size_t m_Block;
+		size_t m_Used;
+		size_t m_Limit;
+		size_t m_Allocated;
+
+	public:
+		NodeArena()
+			: m_Block(0), m_Used(0), m_Limit(0), m_Allocated(0) {}
+
+		void Reset(size_t limit)
+		{
+			m_Block = 0;
+			m_Used = 0;
+			m_Limit = limit;
+			m_Allocated = 0;
+		}
+
+		// count consecutive nodes, nullptr when the arena is out of budget
+		Node* Allocate(int count)
+		{
+			if (m_Allocated + count > m_Limit)
+				return nullptr;
+			if (m_Blocks.empty() || m_Used + count > BLOCK_SIZE)
+			{
+				if (!m_Blocks.empty())
+					m_Block++;
+				if (m_Block == m_Blocks.size())
+					m_Blocks.emplace_back(new Node[BLOCK_SIZE]);
+				m_Used = 0;
+			}
+			Node* nodes = m_Blocks[m_Block].get() + m_Used;
+			m_Used += count;
+			m_Allocated += count;
+			return nodes;
+		}
+	};
+
+	// xorshift, one per thread
+	struct Random
+	{
+		uint64_t state;
+
+		explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+		uint32_t Next(uint32_t bound)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return static_cast<uint32_t>(((state >> 32) * bound) >> 32);
+		}
+	};
+
+	Settings m_Settings;
+	Node m_Root;
+	std::vector<NodeArena> m_Arenas;
+	std::vector<ThreadStatistics> m_Statistics;
+	std::atomic<uint64_t> m_Playouts;
+
+public:
+	explicit Mcts(const Settings& settings = Settings())
+		: m_Settings(settings), m_Playouts(0)
+	{
+		if (m_Settings.threads <= 0)
+			m_Settings.threads = std::max(1u, std::thread::hardware_concurrency());
+		m_Arenas.resize(m_Settings.threads);
+	}
+
+	inline const Settings& GetSettings() const { return m_Settings; }
+	inline const std::vector<ThreadStatistics>& GetStatistics() const { return m_Statistics; }
+
+	// The most visited cell after the budget runs out (or `stop` is set), -1 if the game is over.
+	int Search(const BoardType& board, const std::atomic<bool>* stop = nullptr)
+	{
+		if (board.IsOver())
+			return -1;
+
+		m_Root.Reset(-1);
+		m_Playouts.store(0);
+		m_Statistics.assign(m_Settings.threads, ThreadStatistics());
+		for (NodeArena& arena : m_Arenas)
+			arena.Reset(m_Settings.max_nodes / m_Settings.threads);
+		// the root gets its children up front, so the threads start spreading at once
+		Expand(m_Root, board, m_Arenas[0]);
+
+		std::vector<std::thread> workers;
+		for (int i = 1; i < m_Settings.threads; i++)
+			workers.emplace_back(&Mcts::Work, this, board, i, stop);
+		Work(board, 0, stop);
+		for (std::thread& worker : workers)
+			worker.join();
+
+		int best_move = -1, best_visits = -1;
+		for (int i = 0; i < m_Root.child_count; i++)
+		{
+			int visits = m_Root.children[i].visits.load(std::memory_order_relaxed);
+			if (visits > best_visits)
+			{
+				best_visits = visits;
+				best_move = m_Root.children[i].move;
+			}
+		}
+		return best_move;
+	}
+
+private:
+	bool Expand(Node& node, const BoardType& board, NodeArena& arena)
+	{
+		int expected = LEAF;
+		if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire))
+			return false;
+		int count = CELLS - board.MoveCount();
+		Node* children = arena.Allocate(count);
+		if (children == nullptr)
+		{
+			// out of nodes: stays a leaf for good
+			node.state.store(EXPANDING, std::memory_order_release);
+			return false;
+		}
+		int child = 0;
+		for (int cell = 0; cell < CELLS; cell++)
+		{
+			if (board.IsEmpty(cell))
+				children[child++].Reset(cell);
+		}
+		node.children = children;
+		node.child_count = static_cast<int16_t>(count);
+		node.state.store(EXPANDED, std::memory_order_release);
+		return true;
+	}
+
+	Node* Select(Node& node)
+	{
+		const double log_visits = std::log(static_cast<double>(node.visits.load(std::memory_order_relaxed) + 1));
+		Node* best = nullptr;
+		double best_value = -1.0;
+		for (int i = 0; i < node.child_count; i++)
+		{
+			Node& child = node.children[i];
+			int visits = child.visits.load(std::memory_order_relaxed);
+			if (visits == 0)
+				return &child;
+			double mean = child.score.load(std::memory_order_relaxed) / (2.0 * visits);
+			double value = mean + m_Settings.exploration * std::sqrt(log_visits / visits);
+			if (value > best_value)
+			{
+				best_value = value;
+				best = &child;
+			}
+		}
+		return best;
+	}
+
+	// random moves until the game ends
+	static Figure Playout(BoardType board, Random& random)
+	{
+		int16_t empty[CELLS];
+		int count = 0;
+		for (int cell = 0; cell < CELLS; cell++)
+		{
+			if (board.IsEmpty(cell))
+				empty[count++] = static_cast<int16_t>(cell);
+		}
+		while (!board.IsOver())
+		{
+			int pick = random.Next(count);
+			board.Play(empty[pick]);
+			empty[pick] = empty[--count];
+		}
+		return board.Winner();
+	}
+
+	void Work(BoardType root_board, int thread, const std::atomic<bool>* stop)
+	{
+		NodeArena& arena = m_Arenas[thread];
+		Random random(thread + 1 + static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+		Node* path[CELLS + 1];
+		// the path down the tree is played on this board and taken back after every playout;
+		// the playout itself gets a copy, one copy is cheaper than taking back a whole game
+		BoardType board = root_board;
+		auto start = std::chrono::steady_clock::now();
+		uint64_t playouts = 0;
+
+		while (true)
+		{
+			// check the budget
+			if (stop != nullptr && stop->load(std::memory_order_relaxed))
+				break;
+			if (m_Settings.playouts != 0 && m_Playouts.fetch_add(1, std::memory_order_relaxed) >= m_Settings.playouts)
+				break;
+			if (m_Settings.seconds > 0.0 && (playouts & 63) == 0)
+			{
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				if (elapsed.count() >= m_Settings.seconds)
+					break;
+			}
+
+			// selection, with a virtual loss on the way down
+			Node* node = &m_Root;
+			int depth = 0;
+			path[depth++] = node;
+			node->visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+			while (!board.IsOver())
+			{
+				if (node->state.load(std::memory_order_acquire) != EXPANDED)
+				{
+					if (node->visits.load(std::memory_order_relaxed) < m_Settings.expand_after || !Expand(*node, board, arena))
+						break;
+				}
+				node = Select(*node);
+				board.Play(node->move);
+				path[depth++] = node;
+				node->visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+			}
+
+			// simulation
+			Figure winner = board.IsOver() ? board.Winner() : Playout(board, random);
+			while (board.MoveCount() > root_board.MoveCount())
+				board.Undo();
+
+			// backpropagation: the virtual loss turns into a real visit
+			Figure mover = (root_board.ToMove() == Figure::Cross) ? Figure::Circle : Figure::Cross;
+			for (int i = 0; i < depth; i++)
+			{
+				int reward = (winner == Figure::None) ? 1 : (winner == mover ? 2 : 0);
+				path[i]->score.fetch_add(reward, std::memory_order_relaxed);
+				path[i]->visits.fetch_add(1 - VIRTUAL_LOSS, std::memory_order_relaxed);
+				mover = (mover == Figure::Cross) ? Figure::Circle : Figure::Cross;
+			}
+			playouts++;
+		}
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		m_Statistics[thread].playouts = playouts;
+		m_Statistics[thread].seconds = elapsed.count();
+	}
+};
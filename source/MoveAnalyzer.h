@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Solver.h"
+#include "LockFreeQueue.h"
+#include "WorkStealingPool.h"
+
+
+namespace analyzer_detail
+{
+	// 3x3 and smaller: the exact value of every move. Each worker has its own solver, whose
+	// table keeps the positions of earlier analyses, so later ones are mostly lookups.
+	template<typename BoardType, bool EXACT = (BoardType::CELLS <= 9)>
+	class Evaluator
+	{
+	private:
+		Solver<BoardType> m_Solver;
+
+	public:
+		explicit Evaluator(int) : m_Solver(13) {}
+
+		template<typename Stale, typename Publish>
+		void Evaluate(const BoardType& board, int cell, Stale, Publish publish)
+		{
+			BoardType child = board;
+			child.Play(cell);
+			int value = -m_Solver.Solve(child);
+			publish(value > 0 ? 1.0f : (value < 0 ? -1.0f : 0.0f), 0);
+		}
+	};
+
+	// Bigger boards: random playouts after the move, the average result is published after
+	// every batch so the estimate sharpens on the screen, and a stale analysis stops between two.
+	template<typename BoardType>
+	class Evaluator<BoardType, false>
+	{
+	public:
+		static const int PLAYOUTS = 4096;
+		static const int BATCH = 256;
+
+	private:
+		static const int CELLS = BoardType::CELLS;
+
+		// xorshift, one per worker
+		uint64_t m_Random;
+
+		uint32_t Next(uint32_t bound)
+		{
+			m_Random ^= m_Random << 13;
+			m_Random ^= m_Random >> 7;
+			m_Random ^= m_Random << 17;
+			return static_cast<uint32_t>(((m_Random >> 32) * bound) >> 32);
+		}
+
+	public:
+		explicit Evaluator(int worker)
+			: m_Random((worker + 1) * 0x9E3779B97F4A7C15ull + 1) {}
+
+		template<typename Stale, typename Publish>
+		void Evaluate(const BoardType& board, int cell, Stale stale, Publish publish)
+		{
+			Figure mover = board.ToMove();
+			BoardType child = board;
+			child.Play(cell);
+			if (child.IsOver())
+			{
+				publish(child.Winner() == mover ? 1.0f : 0.0f, 0);
+				return;
+			}
+
+			int16_t empty[CELLS];
+			int empty_count = 0;
+			for (int i = 0; i < CELLS; i++)
+			{
+				if (child.IsEmpty(i))
+					empty[empty_count++] = static_cast<int16_t>(i);
+			}
+
+			int sum = 0;
+			for (int playouts = BATCH; playouts <= PLAYOUTS; playouts += BATCH)
+			{
+				if (stale())
+					return;
+				for (int i = 0; i < BATCH; i++)
+				{
+					BoardType playout = child;
+					int16_t cells[CELLS];
+					std::copy(empty, empty + empty_count, cells);
+					int count = empty_count;
+					while (!playout.IsOver())
+					{
+						int pick = Next(count);
+						playout.Play(cells[pick]);
+						cells[pick] = cells[--count];
+					}
+					Figure winner = playout.Winner();
+					sum += winner == mover ? 1 : (winner == Figure::None ? 0 : -1);
+				}
+				publish(static_cast<float>(sum) / playouts, playouts);
+			}
+		}
+	};
+}
+
+
+// Analysis of every candidate move of a position in the background: Start() hands the
+// position to a pool of workers, one task per empty cell, and the results come back through
+// a lock-free queue that the render loop drains with Poll() without ever waiting. Every
+// Start() or Cancel() begins a new generation; the tasks of older ones give up as soon as
+// they notice, and whatever they already sent is dropped by Poll().
+template<typename BoardType>
+class MoveAnalyzer
+{
+public:
+	struct Result
+	{
+		uint32_t generation;
+		int16_t cell;
+		// how the move turns out for the side playing it, from -1 (lost) over 0 (draw) to 1 (won)
+		float score;
+		// playouts behind the score, 0 if it is exact
+		uint32_t playouts;
+	};
+
+private:
+	using Evaluator = analyzer_detail::Evaluator<BoardType>;
+
+	// room for a few updates of every cell, the render loop takes them out every frame
+	static const size_t QUEUE_CAPACITY = 4 * BoardType::CELLS < 256 ? 256 : 4 * BoardType::CELLS;
+
+	std::atomic<uint32_t> m_Generation;
+	LockFreeQueue<Result> m_Results;
+	std::vector<std::unique_ptr<Evaluator>> m_Evaluators;
+	std::function<void()> m_OnResult;
+	// last, so its threads are joined before anything they use goes away
+	WorkStealingPool m_Pool;
+
+public:
+	// threads: 0 for all hardware threads but one, which is left to the render loop
+	explicit MoveAnalyzer(int threads = 0)
+		: m_Generation(0), m_Results(QUEUE_CAPACITY),
+		m_Pool(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1))
+	{
+		for (int worker = 0; worker < m_Pool.GetThreadCount(); worker++)
+			m_Evaluators.emplace_back(new Evaluator(worker));
+	}
+	~MoveAnalyzer() { Cancel(); }
+
+	MoveAnalyzer(const MoveAnalyzer&) = delete;
+	MoveAnalyzer& operator=(const MoveAnalyzer&) = delete;
+
+	// called on a worker after every result (for instance to wake up a sleeping render loop), set it before the first Start
+	void SetOnResult(std::function<void()> on_result) { m_OnResult = on_result; }
+
+	// analyze the moves of the position (the analysis of the previous one is dropped)
+	void Start(const BoardType& board)
+	{
+		uint32_t generation = ++m_Generation;
+		if (board.IsOver())
+			return;
+		std::shared_ptr<const BoardType> position = std::make_shared<const BoardType>(board);
+		for (int cell = 0; cell < BoardType::CELLS; cell++)
+		{
+			if (board.IsEmpty(cell))
+				m_Pool.Submit([this, position, cell, generation](int worker) { Run(*position, cell, generation, worker); });
+		}
+	}
+
+	// drop the running analysis
+	void Cancel() { ++m_Generation; }
+
+	// block until every task has returned, after Cancel() that takes at most one batch of playouts
+	void Wait() { m_Pool.Wait(); }
+
+	// From the thread that calls Start: the next result of the current analysis, false if there is none yet.
+	// A cell can come more than once, the later result is the better one.
+	bool Poll(Result& result)
+	{
+		while (m_Results.Pop(result))
+		{
+			if (result.generation == m_Generation.load(std::memory_order_relaxed))
+				return true;
+		}
+		return false;
+	}
+
+	inline int GetThreadCount() const { return m_Pool.GetThreadCount(); }
+
+private:
+	inline bool IsStale(uint32_t generation) const { return m_Generation.load(std::memory_order_relaxed) != generation; }
+
+	void Run(const BoardType& board, int cell, uint32_t generation, int worker)
+	{
+		if (IsStale(generation))
+			return;
+		m_Evaluators[worker]->Evaluate(board, cell, [&] { return IsStale(generation); }, [&](float score, uint32_t playouts)
+		{
+			Result result = { generation, static_cast<int16_t>(cell), score, playouts };
+			// full only if the render loop is busy for a moment, a stale result isn't worth waiting for
+			while (!m_Results.Push(result))
+			{
+				if (IsStale(generation))
+					return;
+				std::this_thread::yield();
+			}
+			if (m_OnResult)
+				m_OnResult();
+		});
+	}
+};
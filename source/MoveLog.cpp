@@ -0,0 +1,102 @@
+#include "MoveLog.h"
+
+#include <iostream>
+#include <cstring>
+#include <ctime>
+
+
+MoveLogWriter::MoveLogWriter()
+	: m_Count(0) {}
+
+MoveLogWriter::~MoveLogWriter()
+{
+	Close();
+}
+
+bool MoveLogWriter::Open(const std::string& filepath, int width, int height, int in_a_row)
+{
+	Close();
+	m_Stream.open(filepath, std::ios::binary | std::ios::trunc);
+	if (!m_Stream)
+		return false;
+
+	MoveLogHeader header = {};
+	std::memcpy(header.magic, "TTTR", 4);
+	header.version = VERSION;
+	header.width = static_cast<uint8_t>(width);
+	header.height = static_cast<uint8_t>(height);
+	header.in_a_row = static_cast<uint8_t>(in_a_row);
+	header.start_time = static_cast<int64_t>(std::time(nullptr));
+	m_Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	m_Buffer.resize(BUFFER_EVENTS);
+	m_Count = 0;
+	m_Start = std::chrono::steady_clock::now();
+	return static_cast<bool>(m_Stream);
+}
+
+void MoveLogWriter::Close()
+{
+	if (!IsOpen())
+		return;
+	Flush();
+	m_Stream.close();
+}
+
+void MoveLogWriter::Append(MoveEventType type, MoveSource source, int cell)
+{
+	if (!IsOpen())
+		return;
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_Start);
+	m_Buffer[m_Count++] = { static_cast<uint32_t>(elapsed.count()), type, source, static_cast<uint16_t>(cell) };
+	// a finished game is on disk even if the program dies later
+	if (m_Count == m_Buffer.size() || type == EVENT_RESET)
+		Flush();
+}
+
+void MoveLogWriter::Flush()
+{
+	if (m_Count == 0)
+		return;
+	m_Stream.write(reinterpret_cast<const char*>(m_Buffer.data()), m_Count * sizeof(MoveEvent));
+	m_Stream.flush();
+	m_Count = 0;
+}
+
+
+MoveLogReader::MoveLogReader()
+	: m_Header(nullptr), m_Events(nullptr), m_EventCount(0) {}
+
+bool MoveLogReader::Open(const std::string& filepath)
+{
+	m_Header = nullptr;
+	if (!m_File.Open(filepath))
+		return false;
+
+	const char* data = static_cast<const char*>(m_File.GetData());
+	const MoveLogHeader* header = reinterpret_cast<const MoveLogHeader*>(data);
+	if (m_File.GetSize() < sizeof(MoveLogHeader) || std::memcmp(header->magic, "TTTR", 4) != 0)
+	{
+		std::cout << "Warning: " << filepath << " is not a move log!" << std::endl;
+		m_File.Close();
+		return false;
+	}
+	if (header->version < MoveLogWriter::MIN_VERSION || header->version > MoveLogWriter::VERSION)
+	{
+		std::cout << "Warning: " << filepath << " has log version " << header->version << ", expected "
+			<< MoveLogWriter::MIN_VERSION << " to " << MoveLogWriter::VERSION << std::endl;
+		m_File.Close();
+		return false;
+	}
+
+	// a partly written last event is ignored
+	m_Events = reinterpret_cast<const MoveEvent*>(data + sizeof(MoveLogHeader));
+	m_EventCount = (m_File.GetSize() - sizeof(MoveLogHeader)) / sizeof(MoveEvent);
+	m_Header = header;
+	return true;
+}
+
+bool MoveLogReader::IsFor(int width, int height, int in_a_row) const
+{
+	return m_Header != nullptr && m_Header->width == width && m_Header->height == height && m_Header->in_a_row == in_a_row;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+
+#include "MappedFile.h"
+#include "Board.h"
+
+
+// Binary move log (little-endian): a MoveLogHeader followed by MoveEvents until the end
+// of the file. There is no event count, so a log cut short by a crash stays readable.
+// Versions: 1 moves and resets, 2 adds EVENT_UNDO (a reader that doesn't know it would
+// replay such a log to the wrong board, so it has to refuse the version).
+struct MoveLogHeader
+{
+	char magic[4];          // "TTTR"
+	uint16_t version;
+	uint8_t width;
+	uint8_t height;
+	uint8_t in_a_row;
+	uint8_t reserved[7];
+	int64_t start_time;     // seconds since the Unix epoch
+};
+static_assert(sizeof(MoveLogHeader) == 24, "MoveLogHeader must match the file layout");
+
+enum MoveEventType : uint8_t
+{
+	EVENT_MOVE = 0,   // a figure was put into cell, the board may refuse it (taken cell, game over)
+	EVENT_RESET = 1,  // the board was cleared
+	EVENT_UNDO = 2,   // the last figure was taken back
+};
+
+enum MoveSource : uint8_t
+{
+	SOURCE_HUMAN = 0,
+	SOURCE_COMPUTER = 1,
+};
+
+struct MoveEvent
+{
+	uint32_t time_ms;  // since the log was opened
+	uint8_t type;      // MoveEventType
+	uint8_t source;    // MoveSource
+	uint16_t cell;
+};
+static_assert(sizeof(MoveEvent) == 8, "MoveEvent must match the file layout");
+
+
+// Appends events to a log file. Events go into a buffer allocated by Open, which is
+// written out when it is full, on a reset and on Close, so Append never allocates.
+class MoveLogWriter
+{
+public:
+	static const uint16_t VERSION = 2;
+	// the oldest version MoveLogReader still reads
+	static const uint16_t MIN_VERSION = 1;
+	static const size_t BUFFER_EVENTS = 4096;
+
+private:
+	std::ofstream m_Stream;
+	std::vector<MoveEvent> m_Buffer;
+	size_t m_Count;
+	std::chrono::steady_clock::time_point m_Start;
+
+public:
+	MoveLogWriter();
+	~MoveLogWriter();
+
+	MoveLogWriter(const MoveLogWriter&) = delete;
+	MoveLogWriter& operator=(const MoveLogWriter&) = delete;
+
+	bool Open(const std::string& filepath, int width, int height, int in_a_row);
+	void Close();
+	inline bool IsOpen() const { return m_Stream.is_open(); }
+
+	// does nothing if the log isn't open
+	void Append(MoveEventType type, MoveSource source, int cell);
+	void Flush();
+};
+
+
+// Read-only, memory-mapped view of a log.
+class MoveLogReader
+{
+private:
+	MappedFile m_File;
+	const MoveLogHeader* m_Header;
+	const MoveEvent* m_Events;
+	size_t m_EventCount;
+
+public:
+	MoveLogReader();
+
+	// returns false if the file is missing or isn't a move log
+	bool Open(const std::string& filepath);
+
+	inline const MoveLogHeader& GetHeader() const { return *m_Header; }
+	inline const MoveEvent* GetEvents() const { return m_Events; }
+	inline size_t GetEventCount() const { return m_EventCount; }
+	bool IsFor(int width, int height, int in_a_row) const;
+};
+
+
+struct ReplayResult
+{
+	uint64_t events = 0;
+	uint64_t moves = 0;     // accepted by the board
+	uint64_t rejected = 0;  // refused by the board
+	uint64_t games = 0;
+	uint64_t wins[3] = {};  // draw or unfinished, cross, circle
+};
+
+// Runs the events through the game rules, no window or GL needed. on_game(board, index of
+// the reset or of the last event) is called for every game, finished or not, when it ends.
+template<typename BoardType, typename OnGame>
+ReplayResult ReplayMoves(const MoveEvent* events, size_t count, OnGame on_game)
+{
+	ReplayResult result;
+	BoardType board;
+	auto end_game = [&](size_t index)
+	{
+		if (board.MoveCount() == 0)
+			return;
+		result.games++;
+		result.wins[static_cast<int>(board.Winner()) + 1]++;
+		on_game(board, index);
+	};
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const MoveEvent& event = events[i];
+		result.events++;
+		if (event.type == EVENT_RESET)
+		{
+			end_game(i);
+			board = BoardType();
+		}
+		else if (event.type == EVENT_MOVE)
+		{
+			if (board.Play(event.cell))
+				result.moves++;
+			else
+				result.rejected++;
+		}
+		else if (event.type == EVENT_UNDO && board.MoveCount() > 0)
+			board.Undo();
+	}
+	end_game(count == 0 ? 0 : count - 1);
+	return result;
+}
@@ -0,0 +1,91 @@
+#include "OpeningBook.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+
+OpeningBook::OpeningBook()
+	: m_Header(nullptr), m_Keys(nullptr), m_Values(nullptr), m_BestMoves(nullptr) {}
+
+
+bool OpeningBook::Load(const std::string& filepath)
+{
+	m_Header = nullptr;
+	if (!m_File.Open(filepath))
+		return false;
+
+	const char* data = static_cast<const char*>(m_File.GetData());
+	const BookHeader* header = reinterpret_cast<const BookHeader*>(data);
+	if (m_File.GetSize() < sizeof(BookHeader) || std::memcmp(header->magic, "TTTB", 4) != 0)
+	{
+		std::cout << "Warning: " << filepath << " is not a book file!" << std::endl;
+		m_File.Close();
+		return false;
+	}
+	if (header->version != VERSION)
+	{
+		std::cout << "Warning: " << filepath << " has book version " << header->version << ", expected " << VERSION << std::endl;
+		m_File.Close();
+		return false;
+	}
+	size_t count = header->entry_count;
+	if (m_File.GetSize() != sizeof(BookHeader) + count * (sizeof(uint64_t) + 2))
+	{
+		std::cout << "Warning: " << filepath << " is truncated!" << std::endl;
+		m_File.Close();
+		return false;
+	}
+
+	// the header is 32 bytes, so the keys stay 8-byte aligned in the mapping
+	m_Keys = reinterpret_cast<const uint64_t*>(data + sizeof(BookHeader));
+	m_Values = reinterpret_cast<const int8_t*>(m_Keys + count);
+	m_BestMoves = m_Values + count;
+	m_Header = header;
+	return true;
+}
+
+bool OpeningBook::Write(const std::string& filepath, int width, int height, int in_a_row, int max_stones,
+	uint8_t flags, std::vector<BookEntry> entries)
+{
+	std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+
+	BookHeader header = {};
+	std::memcpy(header.magic, "TTTB", 4);
+	header.version = VERSION;
+	header.width = static_cast<uint8_t>(width);
+	header.height = static_cast<uint8_t>(height);
+	header.in_a_row = static_cast<uint8_t>(in_a_row);
+	header.flags = flags;
+	header.max_stones = static_cast<uint16_t>(max_stones);
+	header.entry_count = static_cast<uint32_t>(entries.size());
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+		return false;
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const BookEntry& entry : entries)
+		stream.write(reinterpret_cast<const char*>(&entry.key), sizeof(entry.key));
+	for (const BookEntry& entry : entries)
+		stream.write(reinterpret_cast<const char*>(&entry.value), 1);
+	for (const BookEntry& entry : entries)
+		stream.write(reinterpret_cast<const char*>(&entry.best_move), 1);
+	return static_cast<bool>(stream);
+}
+
+bool OpeningBook::IsFor(int width, int height, int in_a_row) const
+{
+	return IsLoaded() && m_Header->width == width && m_Header->height == height && m_Header->in_a_row == in_a_row;
+}
+
+int OpeningBook::Find(uint64_t key) const
+{
+	if (!IsLoaded())
+		return -1;
+	const uint64_t* end = m_Keys + m_Header->entry_count;
+	const uint64_t* found = std::lower_bound(m_Keys, end, key);
+	if (found == end || *found != key)
+		return -1;
+	return static_cast<int>(found - m_Keys);
+}
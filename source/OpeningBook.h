@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Symmetry.h"
+
+
+// Binary book file (little-endian), all positions are stored once up to symmetry:
+//   BookHeader
+//   uint64_t keys[entry_count]        canonical keys (see Symmetry::CanonicalKey), sorted
+//   int8_t   values[entry_count]      game value for the side to move (see Solver)
+//   int8_t   best_moves[entry_count]  best cell in the canonical orientation, -1 if the game is over
+struct BookHeader
+{
+	char magic[4];          // "TTTB"
+	uint16_t version;
+	uint8_t width;
+	uint8_t height;
+	uint8_t in_a_row;
+	uint8_t flags;
+	uint16_t max_stones;    // positions with more stones than this aren't stored (partial books)
+	uint32_t entry_count;
+	uint32_t reserved[4];
+};
+static_assert(sizeof(BookHeader) == 32, "BookHeader must match the file layout");
+
+struct BookEntry
+{
+	uint64_t key;
+	int8_t value;
+	int8_t best_move;
+};
+
+
+// Memory-mapped book: lookups are a binary search over the mapped keys,
+// with no allocation or parsing after Load.
+class OpeningBook
+{
+public:
+	static const uint16_t VERSION = 1;
+	// every reachable position is in the book, a miss means the position can't happen
+	static const uint8_t FLAG_COMPLETE = 1;
+
+private:
+	MappedFile m_File;
+	const BookHeader* m_Header;
+	const uint64_t* m_Keys;
+	const int8_t* m_Values;
+	const int8_t* m_BestMoves;
+
+public:
+	OpeningBook();
+
+	// returns false (and leaves the book empty) if the file is missing or isn't a valid book
+	bool Load(const std::string& filepath);
+	static bool Write(const std::string& filepath, int width, int height, int in_a_row, int max_stones,
+		uint8_t flags, std::vector<BookEntry> entries);
+
+	inline bool IsLoaded() const { return m_Header != nullptr; }
+	inline uint32_t GetEntryCount() const { return IsLoaded() ? m_Header->entry_count : 0; }
+	bool IsFor(int width, int height, int in_a_row) const;
+
+	// index of the key in the book, -1 if it isn't there
+	int Find(uint64_t key) const;
+
+	// Game value (for the side to move, see Solver) and best cell of the position.
+	// Returns false if the position isn't in the book; the best cell is -1 when the game is over.
+	template<typename BoardType>
+	bool Lookup(const BoardType& board, int& value, int& best_move) const
+	{
+		using Symmetries = Symmetry<BoardType::WIDTH, BoardType::HEIGHT>;
+		if (!IsFor(BoardType::WIDTH, BoardType::HEIGHT, BoardType::IN_A_ROW))
+			return false;
+		int symmetry;
+		int index = Find(Symmetries::CanonicalKey(board, &symmetry));
+		if (index == -1)
+			return false;
+		value = m_Values[index];
+		best_move = m_BestMoves[index] == -1 ? -1 : Symmetries::Undo(symmetry, m_BestMoves[index]);
+		return true;
+	}
+
+	// The best cell for the side to move, -1 if the position isn't in the book or the game is over.
+	template<typename BoardType>
+	int BestMove(const BoardType& board) const
+	{
+		int value, best_move;
+		return Lookup(board, value, best_move) ? best_move : -1;
+	}
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Perfect ranking of the positions of a board with a given number of figures: every
+// string of CELLS base-3 digits (empty, cross, circle) with (stones + 1) / 2 crosses and
+// stones / 2 circles gets a distinct index in [0, LayerSize(stones)), with no gaps.
+// The index is the rank of the occupied cells among all sets of that size, times the
+// number of ways to pick the crosses among them, plus the rank of the crosses (both in the
+// combinatorial number system). Lets a table hold one entry per position of a layer,
+// where the plain base-3 number would leave most of 3^CELLS unused.
+template<int CELLS>
+class PositionRank
+{
+	static_assert(CELLS <= 32, "PositionRank: the layers of boards over 32 cells don't fit 64-bit indices");
+
+private:
+	struct BinomialTable
+	{
+		uint64_t values[CELLS + 1][CELLS + 1];
+
+		constexpr BinomialTable()
+			: values()
+		{
+			for (int n = 0; n <= CELLS; n++)
+			{
+				values[n][0] = 1;
+				for (int k = 1; k <= n; k++)
+					values[n][k] = values[n - 1][k - 1] + (k <= n - 1 ? values[n - 1][k] : 0);
+			}
+		}
+	};
+
+	static constexpr BinomialTable BINOMIAL = BinomialTable();
+
+public:
+	// n choose k, 0 when k > n
+	inline static uint64_t Binomial(int n, int k) { return BINOMIAL.values[n][k]; }
+
+	inline static int CrossCount(int stones) { return (stones + 1) / 2; }
+
+	static uint64_t LayerSize(int stones)
+	{
+		return Binomial(CELLS, stones) * Binomial(stones, CrossCount(stones));
+	}
+
+	// crosses and circles are bit masks of the cells, stones is the number of bits in both
+	static uint64_t Rank(uint64_t crosses, uint64_t circles, int stones)
+	{
+		uint64_t occupied_rank = 0, cross_rank = 0;
+		int occupied = 0, crossed = 0;
+		uint64_t figures = crosses | circles;
+		for (int cell = 0; cell < CELLS && occupied < stones; cell++)
+		{
+			if ((figures >> cell & 1) == 0)
+				continue;
+			occupied_rank += Binomial(cell, ++occupied);
+			if (crosses >> cell & 1)
+				cross_rank += Binomial(occupied - 1, ++crossed);
+		}
+		return occupied_rank * Binomial(stones, CrossCount(stones)) + cross_rank;
+	}
+
+	static void Unrank(uint64_t rank, int stones, uint64_t& crosses, uint64_t& circles)
+	{
+		uint64_t subsets = Binomial(stones, CrossCount(stones));
+		uint64_t occupied_rank = rank / subsets, cross_rank = rank % subsets;
+
+		// the occupied cells from the highest down, each one the largest that still fits
+		int cells[CELLS];
+		int cell = CELLS - 1;
+		for (int i = stones; i > 0; i--)
+		{
+			while (Binomial(cell, i) > occupied_rank)
+				cell--;
+			occupied_rank -= Binomial(cell, i);
+			cells[i - 1] = cell--;
+		}
+
+		// the same for which of the occupied cells hold crosses
+		crosses = 0;
+		circles = 0;
+		int position = stones - 1;
+		for (int i = CrossCount(stones); i > 0; i--)
+		{
+			while (Binomial(position, i) > cross_rank)
+				circles |= uint64_t(1) << cells[position--];
+			cross_rank -= Binomial(position, i);
+			crosses |= uint64_t(1) << cells[position--];
+		}
+		for (; position >= 0; position--)
+			circles |= uint64_t(1) << cells[position];
+	}
+};
+
+template<int CELLS>
+constexpr typename PositionRank<CELLS>::BinomialTable PositionRank<CELLS>::BINOMIAL;
@@ -0,0 +1,211 @@
+#include "Profiler.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+static const char* PHASE_NAMES[Profiler::PHASE_COUNT] = { "input", "logic", "render", "swap" };
+static const float PHASE_COLORS[Profiler::PHASE_COUNT][4] = {
+	{ 0.3f, 0.6f, 1.0f, 0.8f },
+	{ 1.0f, 0.8f, 0.2f, 0.8f },
+	{ 1.0f, 0.3f, 0.3f, 0.8f },
+	{ 0.6f, 0.6f, 0.6f, 0.8f },
+};
+// the trace stops growing at about 100 MB of JSON
+static const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+
+Profiler::Zone::Zone(Profiler& profiler, Phase phase)
+	: m_Profiler(profiler), m_Phase(phase), m_Start(profiler.Now()) {}
+
+Profiler::Zone::~Zone()
+{
+	double end = m_Profiler.Now();
+	m_Profiler.m_Current.cpu_ms[m_Phase] += static_cast<float>((end - m_Start) / 1000.0);
+	m_Profiler.Record(PHASE_NAMES[m_Phase], m_Start, end - m_Start, 1);
+}
+
+
+Profiler::Profiler()
+	: m_Epoch(std::chrono::steady_clock::now())
+{
+	for (GpuTimer& timer : m_GpuTimers)
+	{
+		GLCall(glGenQueries(1, &timer.query));
+	}
+	m_Trace.reserve(4096);
+}
+
+Profiler::~Profiler()
+{
+	for (GpuTimer& timer : m_GpuTimers)
+	{
+		GLCall(glDeleteQueries(1, &timer.query));
+	}
+}
+
+double Profiler::Now() const
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_Epoch).count();
+}
+
+void Profiler::BeginFrame()
+{
+	m_Current = FrameStats();
+	m_FrameStart = Now();
+}
+
+void Profiler::EndFrame()
+{
+	const GLState::Counters& counters = GLState::GetCounters();
+	m_Current.draw_calls = counters.draw_calls;
+	m_Current.vertices = counters.vertices;
+	m_Current.uniform_uploads = counters.uniform_uploads;
+	m_Current.gpu_ms = m_LastGpuMs;
+	m_History[m_Frames % HISTORY] = m_Current;
+	m_Frames++;
+	Record("frame", m_FrameStart, Now() - m_FrameStart, 0, m_Current);
+}
+
+void Profiler::BeginGpu()
+{
+	GpuTimer& timer = m_GpuTimers[m_GpuTimer];
+	// the query from two frames ago, its result is usually there by now
+	if (timer.pending)
+		ReadGpuTimer(timer);
+	// still not there: skip this frame rather than wait for the GPU
+	if (timer.pending)
+		return;
+	timer.start_us = Now();
+	GLCall(glBeginQuery(GL_TIME_ELAPSED, timer.query));
+	timer.pending = true;
+	m_GpuActive = true;
+}
+
+void Profiler::EndGpu()
+{
+	if (!m_GpuActive)
+		return;
+	GLCall(glEndQuery(GL_TIME_ELAPSED));
+	m_GpuTimer = 1 - m_GpuTimer;
+	m_GpuActive = false;
+}
+
+void Profiler::ReadGpuTimer(GpuTimer& timer)
+{
+	int available = 0;
+	GLCall(glGetQueryObjectiv(timer.query, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+		return;
+	GLuint64 nanoseconds = 0;
+	GLCall(glGetQueryObjectui64v(timer.query, GL_QUERY_RESULT, &nanoseconds));
+	m_LastGpuMs = static_cast<float>(nanoseconds / 1e6);
+	Record("render (gpu)", timer.start_us, nanoseconds / 1e3, 2);
+	timer.pending = false;
+}
+
+void Profiler::Record(const char* name, double start_us, double duration_us, int thread, const FrameStats& stats)
+{
+	if (m_Trace.size() >= MAX_TRACE_EVENTS)
+	{
+		if (!m_TraceFull)
+			std::cout << "Warning: the profiler trace is full, later frames are not recorded" << std::endl;
+		m_TraceFull = true;
+		return;
+	}
+	m_Trace.push_back({ name, start_us, duration_us, thread, stats });
+}
+
+Profiler::FrameStats Profiler::GetAverage() const
+{
+	FrameStats average;
+	int count = GetFrameCount();
+	if (count == 0)
+		return average;
+	for (int i = 0; i < count; i++)
+	{
+		const FrameStats& frame = GetFrame(i);
+		for (int phase = 0; phase < PHASE_COUNT; phase++)
+			average.cpu_ms[phase] += frame.cpu_ms[phase] / count;
+		average.gpu_ms += frame.gpu_ms / count;
+		average.draw_calls += frame.draw_calls;
+		average.vertices += frame.vertices;
+		average.uniform_uploads += frame.uniform_uploads;
+	}
+	average.draw_calls /= count;
+	average.vertices /= count;
+	average.uniform_uploads /= count;
+	return average;
+}
+
+std::string Profiler::Summary() const
+{
+	FrameStats average = GetAverage();
+	std::ostringstream stream;
+	stream << std::fixed << std::setprecision(2);
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+		stream << PHASE_NAMES[phase] << " " << average.cpu_ms[phase] << " ms, ";
+	stream << "gpu " << average.gpu_ms << " ms | " << average.draw_calls << " draws, "
+		<< average.vertices << " vertices, " << average.uniform_uploads << " uniform uploads";
+	return stream.str();
+}
+
+void Profiler::BuildGraph(std::vector<float>& vertices) const
+{
+	// a 60 Hz frame (16.7 ms) is a quarter of the screen high
+	const float HEIGHT_PER_MS = 2.0f / 4.0f / 16.7f;
+	const float BAR_WIDTH = 2.0f / HISTORY;
+	vertices.clear();
+	for (int i = 0; i < GetFrameCount(); i++)
+	{
+		const FrameStats& frame = GetFrame(i);
+		// newest frame on the right
+		float x0 = 1.0f - (i + 1) * BAR_WIDTH;
+		float x1 = x0 + BAR_WIDTH * 0.8f;
+		float y0 = -1.0f;
+		for (int phase = 0; phase < PHASE_COUNT; phase++)
+		{
+			float y1 = y0 + frame.cpu_ms[phase] * HEIGHT_PER_MS;
+			const float corners[6][2] = { { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y0 }, { x1, y1 }, { x0, y1 } };
+			for (const auto& corner : corners)
+			{
+				vertices.insert(vertices.end(), { corner[0], corner[1] });
+				vertices.insert(vertices.end(), PHASE_COLORS[phase], PHASE_COLORS[phase] + 4);
+			}
+			y0 = y1;
+		}
+	}
+}
+
+bool Profiler::WriteTrace(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+	stream << std::fixed << std::setprecision(3);
+	stream << "{\"traceEvents\":[\n";
+	stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+	for (const TraceEvent& event : m_Trace)
+	{
+		stream << ",\n";
+		if (event.thread == 0)
+		{
+			// counters of the frame, and the frame itself on the CPU track
+			stream << "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":" << event.start_us
+				<< ",\"args\":{\"draw calls\":" << event.stats.draw_calls << ",\"vertices\":" << event.stats.vertices
+				<< ",\"uniform uploads\":" << event.stats.uniform_uploads << "}},\n";
+			stream << "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << event.start_us
+				<< ",\"dur\":" << event.duration_us << "}";
+		}
+		else
+		{
+			stream << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+				<< ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us << "}";
+		}
+	}
+	stream << "\n]}\n";
+	return static_cast<bool>(stream);
+}
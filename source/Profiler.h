@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+
+// Frame profiler: CPU time of the phases of a frame (scoped zones), GPU time of the
+// render phase (GL_TIME_ELAPSED queries) and the GLState counters of every frame.
+// Everything is kept in memory and can be written as a Chrome trace (chrome://tracing,
+// ui.perfetto.dev). Needs a current GL context.
+class Profiler
+{
+public:
+	enum Phase { PHASE_INPUT, PHASE_LOGIC, PHASE_RENDER, PHASE_SWAP, PHASE_COUNT };
+
+	struct FrameStats
+	{
+		float cpu_ms[PHASE_COUNT] = {};
+		float gpu_ms = 0.0f;  // of an earlier frame, queries are read back without waiting
+		unsigned int draw_calls = 0;
+		unsigned int vertices = 0;
+		unsigned int uniform_uploads = 0;
+	};
+
+	// Adds the time between construction and destruction to a phase of the current frame.
+	class Zone
+	{
+	private:
+		Profiler& m_Profiler;
+		Phase m_Phase;
+		double m_Start;
+
+	public:
+		Zone(Profiler& profiler, Phase phase);
+		~Zone();
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+	};
+
+	// frames shown by the overlay
+	static const int HISTORY = 120;
+
+private:
+	struct TraceEvent
+	{
+		const char* name;
+		double start_us;
+		double duration_us;
+		int thread;  // 1 CPU, 2 GPU, 0 counters
+		FrameStats stats;
+	};
+
+	// two queries: one is measured while the other one's result is on its way back
+	struct GpuTimer
+	{
+		unsigned int query = 0;
+		double start_us = 0.0;  // CPU time when the query began, where the trace puts it
+		bool pending = false;
+	};
+
+	std::chrono::steady_clock::time_point m_Epoch;
+	GpuTimer m_GpuTimers[2];
+	int m_GpuTimer = 0;
+	bool m_GpuActive = false;  // a query was begun in this frame
+	float m_LastGpuMs = 0.0f;
+
+	FrameStats m_Current;
+	double m_FrameStart = 0.0;
+	FrameStats m_History[HISTORY];
+	int m_Frames = 0;
+
+	std::vector<TraceEvent> m_Trace;
+	bool m_TraceFull = false;
+
+public:
+	Profiler();
+	~Profiler();
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	// Frames that start but don't end (nothing to draw) are dropped from the history.
+	void BeginFrame();
+	void EndFrame();
+
+	// around the GL work of the render phase, must not be nested
+	void BeginGpu();
+	void EndGpu();
+
+	// microseconds since the profiler was created
+	double Now() const;
+
+	// i = 0 is the last finished frame
+	const FrameStats& GetFrame(int i) const { return m_History[(m_Frames - 1 - i + HISTORY) % HISTORY]; }
+	int GetFrameCount() const { return m_Frames < HISTORY ? m_Frames : HISTORY; }
+	// average over the history
+	FrameStats GetAverage() const;
+	std::string Summary() const;
+
+	// Stacked bars of the phases of the last frames along the bottom of the screen:
+	// triangles of x, y (NDC) and r, g, b, a, to draw with Overlay.shader.
+	void BuildGraph(std::vector<float>& vertices) const;
+
+	// Write the recorded zones, GPU timings and counters in the Chrome trace event format.
+	bool WriteTrace(const std::string& filepath) const;
+
+private:
+	void Record(const char* name, double start_us, double duration_us, int thread, const FrameStats& stats);
+	void Record(const char* name, double start_us, double duration_us, int thread) { Record(name, start_us, duration_us, thread, FrameStats()); }
+	void ReadGpuTimer(GpuTimer& timer);
+};
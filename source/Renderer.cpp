@@ -1,24 +1,54 @@
 ﻿#include "Renderer.h"
 
+#include <algorithm>
 
-// iterate through all errors to clear it
-void GLClearError()
+
+void Renderer::Submit(const RenderCommand& command)
 {
-	// GL_NO_ERROR is guaranteed to be 0
-	while (glGetError() != GL_NO_ERROR);
+	// shader | vertex array | primitive | line width in 1/16 pixels
+	uint64_t key = (static_cast<uint64_t>(command.shader->GetRendererID() & 0xFFFF) << 48)
+		| (static_cast<uint64_t>(command.va->GetRendererID() & 0xFFFF) << 32)
+		| (static_cast<uint64_t>(command.mode & 0xFF) << 24)
+		| (static_cast<uint64_t>(command.line_width * 16.0f) & 0xFFFF);
+	m_Order.push_back({ key, static_cast<uint32_t>(m_Commands.size()) });
+	m_Commands.push_back(command);
 }
 
-bool GLCallLog(const char* function, const char* file, int line)
+void Renderer::Flush()
 {
-	// look at line 7 ⬆
-	while (GLenum error = glGetError())
+	std::sort(m_Order.begin(), m_Order.end());
+	for (const auto& order : m_Order)
 	{
-		std::cout << "[ERROR]:" << error << " | " << function << ", " << file << " | " << line;
-		// error has been occured
-		return false;
+		const RenderCommand& command = m_Commands[order.second];
+		if (command.instance_count <= 0)
+			continue;
+		command.shader->Bind();
+		command.va->Bind();
+		if (command.line_width > 0.0f)
+			GLState::LineWidth(command.line_width);
+		if (command.color != nullptr)
+			command.shader->SetUniform(command.color_uniform, *command.color);
+		if (command.transform != nullptr)
+			command.shader->SetUniform(command.transform_uniform, *command.transform);
+
+		if (command.instance_count == 1)
+		{
+			GLCall(glDrawArrays(command.mode, 0, command.count));
+		}
+		else
+		{
+			GLCall(glDrawArraysInstanced(command.mode, 0, command.count, command.instance_count));
+		}
+		GLState::CountDrawCall(command.count * command.instance_count);
 	}
-	// no errors has been spoted
-	return true;
+	m_Commands.clear();
+	m_Order.clear();
+}
+
+void Renderer::BeginFrame()
+{
+	GLState::ResetCounters();
+	GLDebug::BeginFrame();
 }
 
 void Renderer::Draw(const VertexArray& va, const Shader& shader, int count)
@@ -26,6 +56,7 @@ void Renderer::Draw(const VertexArray& va, const Shader& shader, int count)
 	va.Bind();
 	shader.Bind();
 	GLCall(glDrawArrays(GL_LINES, 0, count));
+	GLState::CountDrawCall(count);
 }
 
 void Renderer::DrawElements(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int count)
@@ -34,13 +65,17 @@ void Renderer::DrawElements(const VertexArray& va, const IndexBuffer& ib, const
 	ib.Bind();
 	shader.Bind();
 	GLCall(glDrawElements(GL_LINES, count, GL_UNSIGNED_INT, 0));
+	GLState::CountDrawCall(count);
 }
 
-void Renderer::DrawCircle(const VertexArray& va, const Shader& shader, int count)
+void Renderer::DrawInstanced(const VertexArray& va, const Shader& shader, unsigned int mode, int count, int instance_count)
 {
+	if (instance_count == 0)
+		return;
 	va.Bind();
 	shader.Bind();
-	GLCall(glDrawArrays(GL_LINE_STRIP, 0, count));
+	GLCall(glDrawArraysInstanced(mode, 0, count, instance_count));
+	GLState::CountDrawCall(count * instance_count);
 }
 
 void Renderer::Clear()
@@ -3,27 +3,53 @@
 #include "glad/glad.h"
 
 #include <iostream>
+#include <vector>
+#include <cstdint>
 
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "GLState.h"
+#include "GLDebug.h"
 
 
-#define ASSERT(x) if (!(x)) __debugbreak();
-// find errors
-#define GLCall(x) GLClearError();\
-	x;\
-	ASSERT(GLCallLog(#x, __FILE__, __LINE__))  // # to convert into a string
-	
-
-void GLClearError();
-bool GLCallLog(const char* function, const char* file, int line);
+// One draw, recorded by Renderer::Submit and issued by Renderer::Flush.
+// The pointers must stay valid until the flush.
+struct RenderCommand
+{
+	Shader* shader;
+	const VertexArray* va;
+	unsigned int mode;        // GL_LINES, GL_LINE_STRIP, ...
+	int count;                // vertices
+	int instance_count;       // 1 for a plain draw
+	float line_width;         // 0 leaves the line width as it is
+	// per-draw uniforms, resolved when the shader was loaded; skipped when the value is nullptr
+	Uniform color_uniform;
+	const glm::vec4* color;
+	Uniform transform_uniform;
+	const glm::mat4* transform;
+};
 
 class Renderer
 {
+private:
+	std::vector<RenderCommand> m_Commands;
+	// sort key and index of every submitted command
+	std::vector<std::pair<uint64_t, uint32_t>> m_Order;
+
 public:
+	// Record a draw for this frame. Flush sorts the draws by shader, vertex array, primitive
+	// and line width (submission order breaks ties) and issues them through GLState, so
+	// consecutive draws that share state don't change it again.
+	void Submit(const RenderCommand& command);
+	void Flush();
+
+	// start counting GL calls for a new frame (see GLState::GetCounters)
+	void BeginFrame();
+
 	void Draw(const VertexArray& va, const Shader& shader, int count);
 	void DrawElements(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int count);
-	void DrawCircle(const VertexArray& va, const Shader& shader, int count);
+	// draw count vertices instance_count times in one call, mode is GL_LINES, GL_LINE_STRIP, ...
+	void DrawInstanced(const VertexArray& va, const Shader& shader, unsigned int mode, int count, int instance_count);
 	void Clear();
 };
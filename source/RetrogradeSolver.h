@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "Board.h"
+#include "PositionRank.h"
+#include "MappedFile.h"
+#include "WorkStealingPool.h"
+
+
+// Solves every position of a board by backward induction, for boards whose game tree is
+// too big for Solver's search to finish. Every move adds a figure, so the positions fall
+// into layers by figure count and a layer only depends on the next one: the full boards are
+// solved first, then each layer from the values of the one after it, down to the empty board.
+//
+// Each layer is a file of one int8 value per position in PositionRank order, values as in
+// Solver (CELLS + 1 - moves for a win of the side to move, negative for a loss, 0 a draw).
+// The layer being read is memory-mapped and the layer being solved is written in chunks
+// from the pool, so RAM stays around one chunk per thread however big the board is.
+// A .done file per layer flags the chunks that are written; a stopped run picks up
+// at the first unfinished chunk.
+//
+// Positions no game can reach (both sides with a line, wrong side already won) are solved
+// along with the rest, they just never get looked up.
+template<typename BoardType>
+class RetrogradeSolver
+{
+	static_assert(BoardType::CELLS <= 32, "RetrogradeSolver: the board is too big for the position index");
+
+public:
+	static const int CELLS = BoardType::CELLS;
+
+	struct LayerStatistics
+	{
+		int stones = 0;
+		uint64_t positions = 0;
+		uint64_t chunks = 0;
+		uint64_t resumed_chunks = 0;  // already written by an earlier run
+		// for the side to move, of the positions solved by this run
+		uint64_t wins = 0;
+		uint64_t draws = 0;
+		uint64_t losses = 0;
+		double seconds = 0.0;
+	};
+
+private:
+	using Ranks = PositionRank<CELLS>;
+	using Mask = typename BoardType::Mask;
+
+	std::string m_Directory;
+	uint64_t m_ChunkSize;
+	// every layer mapped by Open, for the lookups
+	std::vector<std::unique_ptr<MappedFile>> m_Layers;
+
+public:
+	// directory has to exist, chunk_size is in positions (= bytes)
+	explicit RetrogradeSolver(const std::string& directory, uint64_t chunk_size = uint64_t(1) << 22)
+		: m_Directory(directory), m_ChunkSize(std::max<uint64_t>(chunk_size, 1)) {}
+
+	std::string LayerPath(int stones, const char* extension) const
+	{
+		return m_Directory + "/" + std::to_string(BoardType::WIDTH) + "x" + std::to_string(BoardType::HEIGHT) + "x"
+			+ std::to_string(BoardType::IN_A_ROW) + "-" + std::to_string(stones) + "." + extension;
+	}
+
+	// Solves the layers that aren't finished yet, reporting each layer when it is done.
+	// Returns false if a file can't be created, read or written.
+	bool Solve(WorkStealingPool& pool, const std::function<void(const LayerStatistics&)>& on_layer)
+	{
+		m_Layers.clear();
+		MappedFile next;
+		for (int stones = CELLS; stones >= 0; stones--)
+		{
+			auto start = std::chrono::steady_clock::now();
+			LayerStatistics statistics;
+			statistics.stones = stones;
+			statistics.positions = Ranks::LayerSize(stones);
+			statistics.chunks = (statistics.positions + m_ChunkSize - 1) / m_ChunkSize;
+
+			std::vector<char> done;
+			if (!PrepareLayer(stones, statistics.positions, statistics.chunks, done))
+				return false;
+			statistics.resumed_chunks = std::count(done.begin(), done.end(), 1);
+
+			const int8_t* next_values = stones == CELLS ? nullptr : static_cast<const int8_t*>(next.GetData());
+			std::mutex done_mutex;
+			std::atomic<bool> failed(false);
+			std::atomic<uint64_t> wins(0), draws(0), losses(0);
+			for (uint64_t chunk = 0; chunk < statistics.chunks; chunk++)
+			{
+				if (done[chunk])
+					continue;
+				pool.Submit([&, chunk](int)
+				{
+					uint64_t first = chunk * m_ChunkSize;
+					uint64_t last = std::min(first + m_ChunkSize, statistics.positions);
+					std::vector<int8_t> values(static_cast<size_t>(last - first));
+					uint64_t counts[3] = {};
+					for (uint64_t index = first; index < last; index++)
+					{
+						int8_t value = SolvePosition(index, stones, next_values);
+						values[index - first] = value;
+						counts[value > 0 ? 0 : (value == 0 ? 1 : 2)]++;
+					}
+					wins += counts[0];
+					draws += counts[1];
+					losses += counts[2];
+					if (!WriteAt(LayerPath(stones, "values"), first, values.data(), values.size()))
+					{
+						failed = true;
+						return;
+					}
+					// only once the values are out, so a stop in between redoes the chunk
+					std::lock_guard<std::mutex> lock(done_mutex);
+					const char flag = 1;
+					if (!WriteAt(LayerPath(stones, "done"), chunk, &flag, 1))
+						failed = true;
+				});
+			}
+			pool.Wait();
+			if (failed)
+				return false;
+
+			statistics.wins = wins;
+			statistics.draws = draws;
+			statistics.losses = losses;
+			statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			on_layer(statistics);
+
+			if (!next.Open(LayerPath(stones, "values")) || next.GetSize() != statistics.positions)
+				return false;
+		}
+		return true;
+	}
+
+	// Maps the finished layers for Value and BestMove, false if any is missing or incomplete.
+	bool Open()
+	{
+		m_Layers.clear();
+		for (int stones = 0; stones <= CELLS; stones++)
+		{
+			std::vector<char> done;
+			uint64_t chunks = (Ranks::LayerSize(stones) + m_ChunkSize - 1) / m_ChunkSize;
+			if (!ReadFlags(LayerPath(stones, "done"), chunks, done) || std::count(done.begin(), done.end(), 1) != static_cast<long long>(chunks))
+				return false;
+			m_Layers.emplace_back(new MappedFile());
+			if (!m_Layers.back()->Open(LayerPath(stones, "values")) || m_Layers.back()->GetSize() != Ranks::LayerSize(stones))
+			{
+				m_Layers.clear();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Game value of the position for the side to move, Open first.
+	int Value(const BoardType& board) const
+	{
+		int stones = board.MoveCount();
+		uint64_t index = Ranks::Rank(board.Crosses(), board.Circles(), stones);
+		return static_cast<const int8_t*>(m_Layers[stones]->GetData())[index];
+	}
+
+	// The best cell for the side to move (the quickest win or the slowest loss), -1 if the game is over.
+	int BestMove(const BoardType& board) const
+	{
+		if (board.IsOver())
+			return -1;
+		int best_move = -1, best_value = -(CELLS + 2);
+		for (int cell = 0; cell < CELLS; cell++)
+		{
+			BoardType child = board;
+			if (!child.Play(cell))
+				continue;
+			int value = -Value(child);
+			if (value > best_value)
+			{
+				best_value = value;
+				best_move = cell;
+			}
+		}
+		return best_move;
+	}
+
+private:
+	static int8_t SolvePosition(uint64_t index, int stones, const int8_t* next_values)
+	{
+		uint64_t crosses, circles;
+		Ranks::Unrank(index, stones, crosses, circles);
+		// the same rules as Board::Play: a line of the side that just moved ends the game
+		uint64_t last_mover = stones % 2 == 0 ? circles : crosses;
+		if (stones > 0 && BoardType::HasLine(static_cast<Mask>(last_mover)))
+			return static_cast<int8_t>(-(CELLS + 1 - stones));
+		if (stones == CELLS)
+			return 0;
+
+		bool cross_to_move = stones % 2 == 0;
+		uint64_t occupied = crosses | circles;
+		int best_value = -(CELLS + 2);
+		for (int cell = 0; cell < CELLS; cell++)
+		{
+			uint64_t bit = uint64_t(1) << cell;
+			if (occupied & bit)
+				continue;
+			uint64_t child = cross_to_move
+				? Ranks::Rank(crosses | bit, circles, stones + 1)
+				: Ranks::Rank(crosses, circles | bit, stones + 1);
+			best_value = std::max(best_value, -static_cast<int>(next_values[child]));
+		}
+		return static_cast<int8_t>(best_value);
+	}
+
+	// Makes sure the values file has its full size and reads which chunks are written.
+	// A values file of the wrong size is started over, along with its flags.
+	bool PrepareLayer(int stones, uint64_t positions, uint64_t chunks, std::vector<char>& done) const
+	{
+		std::string values_path = LayerPath(stones, "values"), done_path = LayerPath(stones, "done");
+		std::ifstream values(values_path, std::ios::binary | std::ios::ate);
+		bool resumable = values && static_cast<uint64_t>(values.tellg()) == positions && ReadFlags(done_path, chunks, done);
+		values.close();
+		if (resumable)
+			return true;
+
+		done.assign(static_cast<size_t>(chunks), 0);
+		{
+			// sized by its last byte, the rest stays a hole until the chunks are written
+			std::ofstream file(values_path, std::ios::binary | std::ios::trunc);
+			file.seekp(static_cast<std::streamoff>(positions - 1));
+			file.put(0);
+			if (!file)
+				return false;
+		}
+		std::ofstream file(done_path, std::ios::binary | std::ios::trunc);
+		file.write(done.data(), done.size());
+		return static_cast<bool>(file);
+	}
+
+	static bool ReadFlags(const std::string& filepath, uint64_t chunks, std::vector<char>& done)
+	{
+		std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+		if (!file || static_cast<uint64_t>(file.tellg()) != chunks)
+			return false;
+		done.resize(static_cast<size_t>(chunks));
+		file.seekg(0);
+		file.read(done.data(), done.size());
+		return static_cast<bool>(file);
+	}
+
+	static bool WriteAt(const std::string& filepath, uint64_t offset, const void* data, size_t size)
+	{
+		std::fstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(static_cast<const char*>(data), size);
+		file.close();
+		return !file.fail();
+	}
+};
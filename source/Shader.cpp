@@ -1,56 +1,173 @@
 #include "Shader.h"
 
 #include "Renderer.h"
+#include "GLState.h"
+#include "GLFeatures.h"
+#include "MappedFile.h"
 
 #include <fstream>
 #include <string>
-#include <sstream>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+std::string Shader::s_CacheDirectory;
+Shader::LoadStatistics Shader::s_LoadStatistics;
+
+// a cached program file: this header, then length bytes of the binary
+struct ProgramBinaryHeader
+{
+	char magic[4];  // "TTTS"
+	uint32_t format;
+	uint64_t key;
+	uint64_t length;
+};
+static_assert(sizeof(ProgramBinaryHeader) == 24, "ProgramBinaryHeader must match the file layout");
+
+
+static std::string ReadFile(const std::string& filepath)
+{
+	std::ifstream stream(filepath, std::ios::binary);
+	std::string text;
+	if (stream.seekg(0, std::ios::end))
+	{
+		text.resize(static_cast<size_t>(stream.tellg()));
+		stream.seekg(0, std::ios::beg);
+		stream.read(&text[0], text.size());
+	}
+	return text;
+}
+
+// FNV-1a of the source and the driver: a new driver may not take the old binaries
+static uint64_t CacheKey(const std::string& source)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](const char* text)
+	{
+		for (; text != nullptr && *text != '\0'; text++)
+		{
+			hash ^= static_cast<unsigned char>(*text);
+			hash *= 1099511628211ull;
+		}
+		hash ^= 0xFF;
+		hash *= 1099511628211ull;
+	};
+	add(source.c_str());
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+	{
+		GLCall(const GLubyte* value = glGetString(name));
+		add(reinterpret_cast<const char*>(value));
+	}
+	return hash;
+}
+
+// GL 4.1 or ARB_get_program_binary, and a driver that offers at least one format
+static bool BinariesSupported()
+{
+#if GL_FEATURE_PROGRAM_BINARY
+	if (!GLFeatures::HasProgramBinary())
+		return false;
+	int formats = 0;
+	GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+	return formats > 0;
+#else
+	return false;
+#endif
+}
+
 
 Shader::Shader(const std::string& filepath)
+	: m_RendererID(0), m_FilePath(filepath)
 {
-	ShaderProgramSource source = ParseShader(filepath);
-	std::cout << "VERTEX SHADER" << std::endl;
-	std::cout << source.VertexSource << std::endl;
-	std::cout << "FRAGMENT SHADER" << std::endl;
-	std::cout << source.FragmentSource << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	std::string text = ReadFile(filepath);
+	if (text.empty())
+		std::cout << "Warning: can't read the shader " << filepath << std::endl;
+
+	std::string cache_path;
+	uint64_t key = 0;
+	if (!s_CacheDirectory.empty() && BinariesSupported())
+	{
+		key = CacheKey(text);
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+		cache_path = s_CacheDirectory + "/" + name;
+	}
+	bool cached = !cache_path.empty() && LoadBinary(cache_path, key);
+	if (!cached)
+	{
+		ShaderProgramSource source = ParseShader(text);
+		m_RendererID = CreateShader(source.VertexSource, source.FragmentSource, !cache_path.empty());
+		if (!cache_path.empty())
+			SaveBinary(cache_path, key);
+	}
+	Reflect();
 
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	s_LoadStatistics.programs++;
+	s_LoadStatistics.cache_hits += cached ? 1 : 0;
+	s_LoadStatistics.seconds += elapsed.count();
 }
 
 Shader::~Shader()
 {
 	glDeleteProgram(m_RendererID);
+	GLState::ProgramDeleted(m_RendererID);
 }
 
+Shader::Shader(Shader&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)),
+	m_Uniforms(std::move(other.m_Uniforms)), m_UniformBlocks(std::move(other.m_UniformBlocks))
+{
+	other.m_RendererID = 0;
+}
 
-ShaderProgramSource Shader::ParseShader(const std::string& file)
+Shader& Shader::operator=(Shader&& other) noexcept
 {
-	std::ifstream stream(file);
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Uniforms, other.m_Uniforms);
+	std::swap(m_UniformBlocks, other.m_UniformBlocks);
+	return *this;
+}
+
 
+ShaderProgramSource Shader::ParseShader(const std::string& source)
+{
 	enum class ShaderType
 	{
 		NONE = -1, VERTEX, FRAGMENT
 	};
 	ShaderType type = ShaderType::NONE;
 
-	std::stringstream string_stream[2];
-	std::string line;
-	while (getline(stream, line))
+	// the lines after a #shader line are copied over in one piece each
+	std::string parts[2];
+	size_t line_start = 0;
+	while (line_start < source.size())
 	{
-		if (line.find("#shader") != std::string::npos)
+		size_t line_end = source.find('\n', line_start);
+		line_end = line_end == std::string::npos ? source.size() : line_end + 1;
+		size_t marker = source.find("#shader", line_start);
+		if (marker < line_end)
 		{
+			std::string line = source.substr(line_start, line_end - line_start);
 			if (line.find("vertex") != std::string::npos)
 				type = ShaderType::VERTEX;
 			else if (line.find("fragment") != std::string::npos)
 				type = ShaderType::FRAGMENT;
 		}
-		else
-		{
-			if (type != ShaderType::NONE)
-				string_stream[static_cast<int>(type)] << line << '\n';
-		}
+		else if (type != ShaderType::NONE)
+			parts[static_cast<int>(type)].append(source, line_start, line_end - line_start);
+		line_start = line_end;
 	}
-	return { string_stream[0].str(), string_stream[1].str() };
+	return { parts[0], parts[1] };
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& shader)
@@ -70,13 +187,13 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& shader)
 		char* message = reinterpret_cast<char*>(malloc(sizeof(char) * length));
 		GLCall(glGetShaderInfoLog(shader_object, length, &length, message));
 		std::cout << "Failed to compile " <<
-			(type == GL_VERTEX_SHADER ? "vertex " : "fragment ") << "shader!";
+			(type == GL_VERTEX_SHADER ? "vertex " : "fragment ") << "shader of " << m_FilePath << "!";
 		std::cout << message << std::endl;
 	}
 	return shader_object;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader, bool retrievable)
 {
 	GLCall(unsigned int vbo = CompileShader(GL_VERTEX_SHADER, vertexShader));
 	GLCall(unsigned int fbo = CompileShader(GL_FRAGMENT_SHADER, fragmentShader));
@@ -84,8 +201,26 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 	GLCall(unsigned int program = glCreateProgram());
 	GLCall(glAttachShader(program, vbo));
 	GLCall(glAttachShader(program, fbo));
+#if GL_FEATURE_PROGRAM_BINARY
+	if (retrievable)
+	{
+		GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+#endif
 	GLCall(glLinkProgram(program));
 
+	int success;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &success));
+	if (!success)
+	{
+		int length;
+		GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+		std::vector<char> message(length + 1);
+		GLCall(glGetProgramInfoLog(program, length, &length, message.data()));
+		std::cout << "Failed to link " << m_FilePath << "!" << std::endl;
+		std::cout << message.data() << std::endl;
+	}
+
 	GLCall(glDeleteShader(vbo));
 	GLCall(glDeleteShader(fbo));
 
@@ -95,33 +230,169 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 
 void Shader::Bind() const
 {
-	GLCall(glUseProgram(m_RendererID));
+	GLState::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-	GLCall(glUseProgram(0));
+	GLState::UseProgram(0);
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+Uniform Shader::GetUniform(const std::string& name) const
 {
-	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+	auto it = m_Uniforms.find(name);
+	if (it == m_Uniforms.end())
+	{
+		std::cout << "Warning: uniform " << name << " doesn't exist in " << m_FilePath << "!" << std::endl;
+		return Uniform();
+	}
+	return Uniform(it->second);
 }
 
-void Shader::SetUniformMat4f(const std::string& name, glm::mat4& matrix)
+bool Shader::BindUniformBlock(const std::string& name, unsigned int binding)
+{
+	auto it = m_UniformBlocks.find(name);
+	if (it == m_UniformBlocks.end())
+	{
+		std::cout << "Warning: uniform block " << name << " doesn't exist in " << m_FilePath << "!" << std::endl;
+		return false;
+	}
+	GLCall(glUniformBlockBinding(m_RendererID, it->second, binding));
+	return true;
+}
+
+void Shader::SetUniform(Uniform uniform, const glm::vec4& value)
+{
+	if (uniform.IsValid())
+	{
+		GLCall(glUniform4f(uniform.GetLocation(), value.x, value.y, value.z, value.w));
+		GLState::CountUniformUpload();
+	}
+}
+
+void Shader::SetUniform(Uniform uniform, const glm::mat4& matrix)
 {
 	// The second parameter specify how many matrices we're passing, which is one in this case. The third parameter specify transpose (switches the row and column)
-	glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]);
+	if (uniform.IsValid())
+	{
+		GLCall(glUniformMatrix4fv(uniform.GetLocation(), 1, GL_FALSE, &matrix[0][0]));
+		GLState::CountUniformUpload();
+	}
+}
+
+void Shader::Reflect()
+{
+	int count = 0;
+	int max_length = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length));
+	std::vector<char> name(max_length + 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length = 0;
+		int size = 0;
+		GLenum type = 0;
+		GLCall(glGetActiveUniform(m_RendererID, i, max_length + 1, &length, &size, &type, name.data()));
+		// members of uniform blocks have no location, they live in the block's buffer
+		GLCall(int location = glGetUniformLocation(m_RendererID, name.data()));
+		if (location == -1)
+			continue;
+		// arrays are reported as name[0]
+		std::string uniform_name(name.data(), length);
+		size_t bracket = uniform_name.find('[');
+		if (bracket != std::string::npos)
+			uniform_name.resize(bracket);
+		m_Uniforms[uniform_name] = location;
+	}
+
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length));
+	name.resize(max_length + 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length = 0;
+		GLCall(glGetActiveUniformBlockName(m_RendererID, i, max_length + 1, &length, name.data()));
+		m_UniformBlocks[std::string(name.data(), length)] = i;
+	}
+}
+
+void Shader::SetCacheDirectory(const std::string& directory)
+{
+	s_CacheDirectory = directory;
+	if (directory.empty())
+		return;
+	// fails harmlessly when it exists already
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+}
+
+// only called with a cache path, which needs BinariesSupported()
+#if GL_FEATURE_PROGRAM_BINARY
+bool Shader::LoadBinary(const std::string& filepath, uint64_t key)
+{
+	MappedFile file;
+	if (!file.Open(filepath) || file.GetSize() < sizeof(ProgramBinaryHeader))
+		return false;
+	const char* data = static_cast<const char*>(file.GetData());
+	ProgramBinaryHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, "TTTS", 4) != 0 || header.key != key || header.length != file.GetSize() - sizeof(header))
+		return false;
+
+	// a format the driver doesn't know would be a GL error, not just a failed load
+	int format_count = 0;
+	GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count));
+	std::vector<int> formats(format_count);
+	GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+	bool known = false;
+	for (int format : formats)
+		known = known || static_cast<uint32_t>(format) == header.format;
+	if (!known)
+		return false;
+
+	GLCall(unsigned int program = glCreateProgram());
+	GLCall(glProgramBinary(program, header.format, data + sizeof(header), static_cast<GLsizei>(header.length)));
+	int success = 0;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &success));
+	if (!success)
+	{
+		std::cout << "Warning: the driver refused the cached program of " << m_FilePath << ", compiling it" << std::endl;
+		GLCall(glDeleteProgram(program));
+		return false;
+	}
+	m_RendererID = program;
+	return true;
+}
+
+void Shader::SaveBinary(const std::string& filepath, uint64_t key) const
+{
+	int success = 0;
+	int length = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_LINK_STATUS, &success));
+	GLCall(glGetProgramiv(m_RendererID, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (!success || length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	GLCall(glGetProgramBinary(m_RendererID, length, &length, &format, binary.data()));
+
+	ProgramBinaryHeader header = { { 'T', 'T', 'T', 'S' }, format, key, static_cast<uint64_t>(length) };
+	std::ofstream stream(filepath, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(binary.data(), length);
+	if (!stream)
+		std::cout << "Warning: can't write the program cache " << filepath << std::endl;
+}
+#else
+bool Shader::LoadBinary(const std::string&, uint64_t)
+{
+	return false;
 }
 
-unsigned int Shader::GetUniformLocation(const std::string& name)
+void Shader::SaveBinary(const std::string&, uint64_t) const
 {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1)
-		std::cout << "Warning: uniform " << name << " doesn't exist!" << std::endl;
-	
-	m_UniformLocationCache[name] = location;
-	return m_UniformLocationCache[name];
 }
+#endif
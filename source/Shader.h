@@ -1,6 +1,8 @@
 #pragma once
 
+#include <string>
 #include <unordered_map>
+#include <cstdint>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,28 +14,81 @@ struct ShaderProgramSource
 	std::string FragmentSource;
 };
 
+// Location of a uniform, looked up once after the program is linked.
+// Setting an invalid handle (the uniform doesn't exist) does nothing.
+class Uniform
+{
+private:
+	int m_Location;
+
+public:
+	Uniform() : m_Location(-1) {}
+	explicit Uniform(int location) : m_Location(location) {}
+
+	inline bool IsValid() const { return m_Location != -1; }
+	inline int GetLocation() const { return m_Location; }
+};
+
 class Shader
 {
+public:
+	// every Shader loaded so far, for startup timing
+	struct LoadStatistics
+	{
+		int programs = 0;
+		int cache_hits = 0;
+		double seconds = 0.0;
+	};
+
 private:
+	static std::string s_CacheDirectory;
+	static LoadStatistics s_LoadStatistics;
+
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::string m_FilePath;
+	// active uniforms and uniform blocks of the linked program, read back from GL
+	std::unordered_map<std::string, int> m_Uniforms;
+	std::unordered_map<std::string, unsigned int> m_UniformBlocks;
 
 public:
 	Shader(const std::string& filepath);
 	~Shader();
 
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, glm::mat4& matrix);
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	// Resolve a uniform when the shader is loaded, warns if the program has no such uniform.
+	Uniform GetUniform(const std::string& name) const;
+	// Connect a uniform block to the binding point of a UniformBuffer, false if the block doesn't exist.
+	bool BindUniformBlock(const std::string& name, unsigned int binding);
+
+	// the shader must be bound
+	void SetUniform(Uniform uniform, const glm::vec4& value);
+	void SetUniform(Uniform uniform, const glm::mat4& matrix);
+
+	// Keep linked programs (glGetProgramBinary) in this directory and load them from there while the
+	// source and the GL vendor, renderer and version stay the same. Empty (the default): always compile.
+	static void SetCacheDirectory(const std::string& directory);
+	inline static const LoadStatistics& GetLoadStatistics() { return s_LoadStatistics; }
 
 private:
-	ShaderProgramSource ParseShader(const std::string& file);
+	// split the file's text at the #shader lines
+	ShaderProgramSource ParseShader(const std::string& source);
 	// Compile a shader object
 	unsigned int CompileShader(unsigned int type, const std::string& shader);
-	// Create a shader object and program
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int GetUniformLocation(const std::string& name);
+	// Create a shader object and program, retrievable: the binary is going to be read back for the cache
+	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader, bool retrievable);
+	// false if there is no usable binary for the key, the program is compiled then
+	bool LoadBinary(const std::string& filepath, uint64_t key);
+	void SaveBinary(const std::string& filepath, uint64_t key) const;
+	// fill m_Uniforms and m_UniformBlocks from the linked program
+	void Reflect();
 };
 
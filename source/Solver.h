@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Board.h"
+#include "Symmetry.h"
+
+
+// Perfect play by negamax with alpha-beta pruning, on one board that moves are played on
+// and taken back from. Every searched position goes into a transposition table under its
+// canonical hash, the smallest of the Zobrist hashes of all its rotations/reflections, so
+// they all share one entry. The hashes of the symmetric boards are updated move by move
+// like the board's own. After the first search of a 3x3 game the whole tree is in the
+// table and every later move is a single lookup.
+//
+// Values are from the point of view of the side to move: a win scores
+// CELLS + 1 - (moves on the board when it happened), so quicker wins score higher; 0 is a draw.
+template<typename BoardType>
+class Solver
+{
+	static_assert(2 * BoardType::CELLS <= 64, "Solver: the board is too big to be solved exactly");
+
+public:
+	static const int CELLS = BoardType::CELLS;
+	static const int INFINITE_VALUE = CELLS + 2;
+
+	struct Statistics
+	{
+		uint64_t nodes = 0;    // positions visited by the search
+		uint64_t probes = 0;   // transposition table lookups
+		uint64_t hits = 0;     // lookups that found the position
+		uint64_t cutoffs = 0;  // lookups that answered the position without searching it
+
+		double HitRate() const { return probes == 0 ? 0.0 : static_cast<double>(hits) / probes; }
+	};
+
+private:
+	using Symmetries = Symmetry<BoardType::WIDTH, BoardType::HEIGHT>;
+
+	enum class Bound : uint8_t
+	{
+		None, Exact, Lower, Upper
+	};
+
+	struct Entry
+	{
+		uint64_t key = 0;
+		int8_t value = 0;
+		// best move in the canonical orientation, -1 if unknown
+		int8_t best_move = -1;
+		Bound bound = Bound::None;
+	};
+
+	std::vector<Entry> m_Table;
+	uint64_t m_IndexMask;
+	Statistics m_Statistics;
+
+public:
+	// table_bits: the table holds 2^table_bits entries (2^13 is plenty for 3x3, which has 5478 positions)
+	explicit Solver(int table_bits = 16)
+		: m_Table(size_t(1) << table_bits), m_IndexMask((uint64_t(1) << table_bits) - 1) {}
+
+	// Game value of the position for the side to move.
+	int Solve(const BoardType& board)
+	{
+		BoardType search = board;
+		uint64_t hashes[Symmetries::COUNT];
+		SymmetricHashes(board, hashes);
+		return Negamax(search, hashes, -INFINITE_VALUE, INFINITE_VALUE);
+	}
+
+	// The best cell for the side to move, -1 if the game is over.
+	int BestMove(const BoardType& board)
+	{
+		if (board.IsOver())
+			return -1;
+		uint64_t hashes[Symmetries::COUNT];
+		SymmetricHashes(board, hashes);
+		int symmetry;
+		uint64_t key = CanonicalHash(hashes, &symmetry);
+		const Entry* entry = Probe(key);
+		if (entry == nullptr || entry->bound != Bound::Exact || entry->best_move == -1)
+		{
+			Solve(board);
+			entry = Probe(key);
+		}
+		return Symmetries::Undo(symmetry, entry->best_move);
+	}
+
+	inline const Statistics& GetStatistics() const { return m_Statistics; }
+	inline void ResetStatistics() { m_Statistics = Statistics(); }
+	void Clear()
+	{
+		m_Table.assign(m_Table.size(), Entry());
+		ResetStatistics();
+	}
+
+private:
+	// hashes[s]: the Zobrist hash of the board after symmetry s, from scratch
+	static void SymmetricHashes(const BoardType& board, uint64_t* hashes)
+	{
+		for (int s = 0; s < Symmetries::COUNT; s++)
+		{
+			hashes[s] = board.ToMove() == Figure::Circle ? BoardType::ZobristSideKey() : 0;
+			for (int cell = 0; cell < CELLS; cell++)
+			{
+				if (!board.IsEmpty(cell))
+					hashes[s] ^= BoardType::ZobristKey(board.At(cell), Symmetries::Apply(s, cell));
+			}
+		}
+	}
+
+	// the smallest of the hashes, and which symmetry it belongs to
+	static uint64_t CanonicalHash(const uint64_t* hashes, int* symmetry)
+	{
+		int best = 0;
+		for (int s = 1; s < Symmetries::COUNT; s++)
+		{
+			if (hashes[s] < hashes[best])
+				best = s;
+		}
+		*symmetry = best;
+		return hashes[best];
+	}
+
+	inline size_t Index(uint64_t key) const
+	{
+		// the low bits of a Zobrist hash are as random as any (the minimum only biases the high ones)
+		return static_cast<size_t>(key) & m_IndexMask;
+	}
+
+	const Entry* Probe(uint64_t key)
+	{
+		m_Statistics.probes++;
+		const Entry& entry = m_Table[Index(key)];
+		if (entry.bound == Bound::None || entry.key != key)
+			return nullptr;
+		m_Statistics.hits++;
+		return &entry;
+	}
+
+	int Negamax(BoardType& board, const uint64_t* hashes, int alpha, int beta)
+	{
+		m_Statistics.nodes++;
+		if (board.Winner() != Figure::None)
+			return -(CELLS + 1 - board.MoveCount());  // the previous move won
+		if (board.IsFull())
+			return 0;
+
+		int symmetry;
+		uint64_t key = CanonicalHash(hashes, &symmetry);
+		int hash_move = -1;
+		if (const Entry* entry = Probe(key))
+		{
+			if (entry->best_move != -1)
+				hash_move = Symmetries::Undo(symmetry, entry->best_move);
+			if (entry->bound == Bound::Exact
+				|| (entry->bound == Bound::Lower && entry->value >= beta)
+				|| (entry->bound == Bound::Upper && entry->value <= alpha))
+			{
+				m_Statistics.cutoffs++;
+				return entry->value;
+			}
+		}
+
+		const int original_alpha = alpha;
+		int best_value = -INFINITE_VALUE;
+		int best_move = -1;
+		// the move from the table first, it is the most likely to cut
+		for (int i = -1; i < CELLS; i++)
+		{
+			int cell = (i == -1) ? hash_move : i;
+			if (cell == -1 || (i != -1 && cell == hash_move) || !board.IsEmpty(cell))
+				continue;
+
+			uint64_t child_hashes[Symmetries::COUNT];
+			for (int s = 0; s < Symmetries::COUNT; s++)
+				child_hashes[s] = hashes[s] ^ BoardType::ZobristKey(board.ToMove(), Symmetries::Apply(s, cell)) ^ BoardType::ZobristSideKey();
+			board.Play(cell);
+			int value = -Negamax(board, child_hashes, -beta, -alpha);
+			board.Undo();
+			if (value > best_value)
+			{
+				best_value = value;
+				best_move = cell;
+			}
+			if (value > alpha)
+				alpha = value;
+			if (alpha >= beta)
+				break;
+		}
+
+		Entry& entry = m_Table[Index(key)];
+		entry.key = key;
+		entry.value = static_cast<int8_t>(best_value);
+		entry.best_move = static_cast<int8_t>(Symmetries::Apply(symmetry, best_move));
+		if (best_value <= original_alpha)
+			entry.bound = Bound::Upper;
+		else if (best_value >= beta)
+			entry.bound = Bound::Lower;
+		else
+			entry.bound = Bound::Exact;
+		return best_value;
+	}
+};
@@ -0,0 +1,131 @@
+#include "StreamBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "GLFeatures.h"
+#include "GLSync.h"
+
+#include <utility>
+
+StreamBuffer::StreamBuffer(int segment_size)
+	: m_SegmentSize(segment_size), m_Segment(SEGMENTS - 1), m_Used(0), m_Persistent(false), m_Mapped(nullptr)
+{
+	for (GLsync& fence : m_Fences)
+		fence = nullptr;
+
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindArrayBuffer(m_RendererID);
+	GLsizeiptr size = static_cast<GLsizeiptr>(segment_size) * SEGMENTS;
+#if GL_FEATURE_BUFFER_STORAGE
+	if (GLFeatures::HasBufferStorage())
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags));
+		GLCall(m_Mapped = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags)));
+		m_Persistent = m_Mapped != nullptr;
+		if (!m_Persistent)
+			std::cout << "Warning: can't map a stream buffer persistently" << std::endl;
+		return;
+	}
+#endif
+	// mapped a segment at a time, see Begin
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (GLsync fence : m_Fences)
+	{
+		if (fence != nullptr)
+		{
+			GLCall(glDeleteSync(fence));
+		}
+	}
+	if (m_Mapped != nullptr)
+	{
+		GLState::BindArrayBuffer(m_RendererID);
+		GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+	}
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::ArrayBufferDeleted(m_RendererID);
+}
+
+StreamBuffer::StreamBuffer(StreamBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_SegmentSize(other.m_SegmentSize), m_Segment(other.m_Segment),
+	m_Used(other.m_Used), m_Persistent(other.m_Persistent), m_Mapped(other.m_Mapped)
+{
+	for (int i = 0; i < SEGMENTS; i++)
+	{
+		m_Fences[i] = other.m_Fences[i];
+		other.m_Fences[i] = nullptr;
+	}
+	other.m_RendererID = 0;
+	other.m_Mapped = nullptr;
+}
+
+StreamBuffer& StreamBuffer::operator=(StreamBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_SegmentSize, other.m_SegmentSize);
+	std::swap(m_Segment, other.m_Segment);
+	std::swap(m_Used, other.m_Used);
+	std::swap(m_Persistent, other.m_Persistent);
+	std::swap(m_Mapped, other.m_Mapped);
+	std::swap(m_Fences, other.m_Fences);
+	return *this;
+}
+
+void StreamBuffer::Begin()
+{
+	m_Segment = (m_Segment + 1) % SEGMENTS;
+	m_Used = 0;
+
+	if (m_Persistent)
+	{
+		WaitFence(m_Fences[m_Segment]);
+		return;
+	}
+
+	GLState::BindArrayBuffer(m_RendererID);
+	if (m_Segment == 0)
+	{
+		// orphan: the driver hands out fresh storage and keeps the old one until the GPU is done with it
+		GLCall(glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_SegmentSize) * SEGMENTS, nullptr, GL_STREAM_DRAW));
+	}
+	// the GPU only reads the other segments of this storage, nothing to synchronize with
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+	GLCall(m_Mapped = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, GetSegmentOffset(), m_SegmentSize, flags)));
+}
+
+void* StreamBuffer::Allocate(int size, int& offset)
+{
+	if (m_Mapped == nullptr || m_Used + size > m_SegmentSize)
+		return nullptr;
+	offset = m_Used;
+	m_Used += size;
+	return (m_Persistent ? m_Mapped + GetSegmentOffset() : m_Mapped) + offset;
+}
+
+void StreamBuffer::End()
+{
+	// coherent mappings are seen by the GPU without any call
+	if (m_Persistent || m_Mapped == nullptr)
+		return;
+	GLState::BindArrayBuffer(m_RendererID);
+	if (m_Used > 0)
+	{
+		GLCall(glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, m_Used));
+	}
+	GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+	m_Mapped = nullptr;
+}
+
+void StreamBuffer::Fence()
+{
+	if (!m_Persistent)
+		return;
+	if (m_Fences[m_Segment] != nullptr)
+	{
+		GLCall(glDeleteSync(m_Fences[m_Segment]));
+	}
+	GLCall(m_Fences[m_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "glad/glad.h"
+
+
+// Vertex data that is rewritten every frame, kept in a ring of SEGMENTS parts of one buffer:
+// the CPU fills one segment while the GPU may still draw from the other two. Within a
+// frame's segment, Allocate hands out sub-ranges, so several batches can share it.
+//
+// With GL 4.4 or ARB_buffer_storage (in the context and in glad, see GLFeatures.h) the whole buffer is mapped once (persistent and coherent)
+// and a fence per segment keeps the CPU from overwriting data the GPU hasn't read yet.
+// Otherwise each segment is mapped with glMapBufferRange for the frame, and the buffer is
+// orphaned whenever the ring wraps around, so the mapping never waits for the GPU.
+class StreamBuffer
+{
+public:
+	static const int SEGMENTS = 3;
+
+private:
+	unsigned int m_RendererID;
+	int m_SegmentSize;
+	int m_Segment;
+	// bytes allocated in the current segment
+	int m_Used;
+	bool m_Persistent;
+	// persistent: the whole buffer, otherwise the current segment between Begin and End
+	char* m_Mapped;
+	GLsync m_Fences[SEGMENTS];
+
+public:
+	// segment_size: the most bytes a frame writes
+	explicit StreamBuffer(int segment_size);
+	~StreamBuffer();
+
+	StreamBuffer(StreamBuffer&& other) noexcept;
+	StreamBuffer& operator=(StreamBuffer&& other) noexcept;
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// move on to the next segment, may wait for the GPU to finish reading it
+	void Begin();
+	// Room for size more bytes in the segment, nullptr if they don't fit. offset: where they
+	// start, counted from the start of the segment. The memory may be write-combined: write it, never read it.
+	void* Allocate(int size, int& offset);
+	// the allocated ranges are written, hand them to GL
+	void End();
+	// after the draws that read the segment have been issued
+	void Fence();
+
+	// the segment being written, its data starts GetSegmentOffset() bytes into the buffer
+	inline int GetSegment() const { return m_Segment; }
+	inline int GetSegmentOffset() const { return m_Segment * m_SegmentSize; }
+	inline int GetSegmentSize() const { return m_SegmentSize; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsPersistent() const { return m_Persistent; }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Rotations and reflections of a W x H board as permutations of its cells.
+// A square board has 8 of them, any other rectangle keeps only 4.
+// Positions that are mirror images of each other share one canonical key.
+template<int W, int H>
+class Symmetry
+{
+public:
+	static const int CELLS = W * H;
+	static const int COUNT = (W == H) ? 8 : 4;
+
+private:
+	// m_Forward[s][cell] is where the symmetry s moves the cell, m_Inverse undoes it
+	int8_t m_Forward[COUNT][CELLS];
+	int8_t m_Inverse[COUNT][CELLS];
+
+	Symmetry()
+	{
+		for (int s = 0; s < COUNT; s++)
+		{
+			for (int cell = 0; cell < CELLS; cell++)
+			{
+				int row = cell / W, column = cell % W;
+				int new_row = row, new_column = column;
+				switch (s)
+				{
+				case 0: break;  // identity
+				case 1: new_row = H - 1 - row; new_column = W - 1 - column; break;  // rotate 180
+				case 2: new_column = W - 1 - column; break;  // mirror left-right
+				case 3: new_row = H - 1 - row; break;  // mirror up-down
+				// only square boards
+				case 4: new_row = column; new_column = W - 1 - row; break;  // rotate 90
+				case 5: new_row = W - 1 - column; new_column = row; break;  // rotate 270
+				case 6: new_row = column; new_column = row; break;  // transpose
+				case 7: new_row = W - 1 - column; new_column = W - 1 - row; break;  // anti-transpose
+				}
+				int new_cell = new_row * W + new_column;
+				m_Forward[s][cell] = static_cast<int8_t>(new_cell);
+				m_Inverse[s][new_cell] = static_cast<int8_t>(cell);
+			}
+		}
+	}
+
+	static const Symmetry& Get()
+	{
+		static const Symmetry symmetry;
+		return symmetry;
+	}
+
+public:
+	inline static int Apply(int s, int cell) { return Get().m_Forward[s][cell]; }
+	inline static int Undo(int s, int cell) { return Get().m_Inverse[s][cell]; }
+
+	template<typename Mask>
+	static uint64_t ApplyToMask(int s, Mask mask)
+	{
+		uint64_t result = 0;
+		for (int cell = 0; mask != 0; cell++, mask >>= 1)
+		{
+			if (mask & 1)
+				result |= 1ull << Apply(s, cell);
+		}
+		return result;
+	}
+
+	// Exact key of the position under the symmetry s: crosses in the low bits, circles above them.
+	template<typename BoardType>
+	static uint64_t Key(const BoardType& board, int s)
+	{
+		return ApplyToMask(s, board.Crosses()) | (ApplyToMask(s, board.Circles()) << CELLS);
+	}
+
+	// The smallest key over all symmetries, and which symmetry produced it.
+	template<typename BoardType>
+	static uint64_t CanonicalKey(const BoardType& board, int* symmetry = nullptr)
+	{
+		static_assert(2 * CELLS <= 64, "Symmetry: the exact key needs 2 bits per cell");
+		uint64_t best = Key(board, 0);
+		int best_symmetry = 0;
+		for (int s = 1; s < COUNT; s++)
+		{
+			uint64_t key = Key(board, s);
+			if (key < best)
+			{
+				best = key;
+				best_symmetry = s;
+			}
+		}
+		if (symmetry != nullptr)
+			*symmetry = best_symmetry;
+		return best;
+	}
+};
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <bitset>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "Board.h"
+
+
+namespace threat_detail
+{
+	// The bit operations the pattern search needs, on Lanes::COUNT lines of 16 cells at once.
+	// One line per value: the fallback, and the few lines of an incremental update.
+	struct ScalarLanes
+	{
+		using Type = uint32_t;
+		static const int COUNT = 1;
+
+		static Type Load(const uint16_t* lines) { return *lines; }
+		static void Store(uint16_t* lines, Type value) { *lines = static_cast<uint16_t>(value); }
+		static Type Zero() { return 0; }
+		static Type And(Type a, Type b) { return a & b; }
+		static Type Or(Type a, Type b) { return a | b; }
+		static Type Xor(Type a, Type b) { return a ^ b; }
+		// ~a & b
+		static Type AndNot(Type a, Type b) { return ~a & b; }
+		static Type Shift(Type value, int cells) { return value >> cells; }
+		static Type Add(Type a, Type b) { return a + b; }
+		// set bits per line
+		static Type PopCount(Type value) { return static_cast<Type>(std::bitset<16>(value).count()); }
+		static int Sum(Type value) { return static_cast<int>(value); }
+	};
+
+#ifdef __AVX2__
+	// 16 lines per 256-bit register, one 16-bit lane each.
+	struct Avx2Lanes
+	{
+		using Type = __m256i;
+		static const int COUNT = 16;
+
+		static Type Load(const uint16_t* lines) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lines)); }
+		static void Store(uint16_t* lines, Type value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(lines), value); }
+		static Type Zero() { return _mm256_setzero_si256(); }
+		static Type And(Type a, Type b) { return _mm256_and_si256(a, b); }
+		static Type Or(Type a, Type b) { return _mm256_or_si256(a, b); }
+		static Type Xor(Type a, Type b) { return _mm256_xor_si256(a, b); }
+		static Type AndNot(Type a, Type b) { return _mm256_andnot_si256(a, b); }
+		static Type Shift(Type value, int cells) { return _mm256_srl_epi16(value, _mm_cvtsi32_si128(cells)); }
+		static Type Add(Type a, Type b) { return _mm256_add_epi16(a, b); }
+
+		// nibble lookup per byte, then the two bytes of each lane added up
+		static Type PopCount(Type value)
+		{
+			const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+			const __m256i nibble = _mm256_set1_epi8(0x0f);
+			__m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(value, nibble)),
+				_mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(value, 4), nibble)));
+			return _mm256_and_si256(_mm256_add_epi16(bytes, _mm256_srli_epi16(bytes, 8)), _mm256_set1_epi16(0xff));
+		}
+
+		static int Sum(Type value)
+		{
+			uint16_t lanes[COUNT];
+			Store(lanes, value);
+			int sum = 0;
+			for (uint16_t lane : lanes)
+				sum += lane;
+			return sum;
+		}
+	};
+#endif
+
+
+	// Where the patterns of one side start on each line, bit s for a pattern starting at cell s:
+	//   windows[n]  K cells without a stone of the other side that hold n own stones (n = 2..K)
+	//   open[n]     n own stones in a row with an empty cell on both ends (n = 2..K-1)
+	// inside has a bit for every cell the line really has.
+	template<typename Lanes, int K>
+	struct PatternKernel
+	{
+		using V = typename Lanes::Type;
+
+		static void Find(V own, V other, V inside, V* windows, V* open)
+		{
+			V free = Lanes::AndNot(other, inside);
+			V empty = Lanes::AndNot(own, free);
+			V clean = free;
+			for (int i = 1; i < K; i++)
+				clean = Lanes::And(clean, Lanes::Shift(free, i));
+
+			// own stones in the window at every start, counted bit-sliced in three counters
+			V count[3] = { Lanes::Zero(), Lanes::Zero(), Lanes::Zero() };
+			for (int i = 0; i < K; i++)
+			{
+				V add = Lanes::Shift(own, i);
+				V carry = Lanes::And(count[0], add);
+				count[0] = Lanes::Xor(count[0], add);
+				V carry2 = Lanes::And(count[1], carry);
+				count[1] = Lanes::Xor(count[1], carry);
+				count[2] = Lanes::Or(count[2], carry2);
+			}
+			for (int n = 2; n <= K; n++)
+			{
+				V match = clean;
+				for (int bit = 0; bit < 3; bit++)
+					match = (n >> bit & 1) ? Lanes::And(match, count[bit]) : Lanes::AndNot(count[bit], match);
+				windows[n] = match;
+			}
+
+			V run = own;
+			for (int n = 2; n < K; n++)
+			{
+				run = Lanes::And(run, Lanes::Shift(own, n - 1));
+				open[n] = Lanes::And(Lanes::And(empty, Lanes::Shift(run, 1)), Lanes::Shift(empty, n + 1));
+			}
+		}
+	};
+}
+
+
+// Heuristic threat count for Gomoku-size boards: open twos, threes and fours and the
+// K-cell windows a side can still fill, for both sides, over all rows, columns and diagonals.
+// Every line is kept as a 16-bit mask per side, so the patterns are found with a handful of
+// shifts and ANDs per line, 16 lines per AVX2 instruction when built with -mavx2.
+// Play and Remove only rescan the four lines through the cell and adjust the totals, which
+// makes Score after a move (or an undo in a search) a few dozen operations.
+template<int W, int H, int K>
+class ThreatEvaluator
+{
+	static_assert(W <= 16 && H <= 16, "ThreatEvaluator: lines are 16-bit masks");
+	static_assert(K >= 3 && K <= 7, "ThreatEvaluator: window stone counts are 3 bits");
+
+public:
+	static const int CELLS = W * H;
+	// rows, columns and both diagonal directions
+	static const int LINES = H + W + 2 * (W + H - 1);
+	// a finished line on the board is worth this much, everything else is far below
+	static const int WIN_SCORE = 1 << 30;
+
+	struct Threats
+	{
+		int windows[K + 1];  // [n]: windows free of the opponent with n stones, [K] is a finished line
+		int open[K];         // [n]: n stones in a row with both ends empty, [3] and [4] are open threes and fours
+	};
+
+private:
+	static const int PADDED_LINES = (LINES + 15) / 16 * 16;
+	// windows with 2..K stones, then open runs of 2..K-1
+	static const int FEATURES = 2 * K - 3;
+	static int WindowFeature(int n) { return n - 2; }
+	static int OpenFeature(int n) { return K - 1 + n - 2; }
+
+	// the line and the bit in it of every cell, in the order row, column, diagonal, anti-diagonal
+	struct Layout
+	{
+		int16_t line[CELLS][4];
+		int8_t bit[CELLS][4];
+		uint16_t inside[PADDED_LINES];
+
+		Layout()
+			: line(), bit(), inside()
+		{
+			for (int cell = 0; cell < CELLS; cell++)
+			{
+				int row = cell / W, column = cell % W;
+				const int lines[4] = { row, H + column, H + W + column - row + H - 1, H + W + (W + H - 1) + row + column };
+				const int bits[4] = { column, row, std::min(row, column), row - std::max(0, row + column - (W - 1)) };
+				for (int direction = 0; direction < 4; direction++)
+				{
+					line[cell][direction] = static_cast<int16_t>(lines[direction]);
+					bit[cell][direction] = static_cast<int8_t>(bits[direction]);
+					inside[lines[direction]] |= static_cast<uint16_t>(1 << bits[direction]);
+				}
+			}
+		}
+	};
+
+	static const Layout& Lines()
+	{
+		static const Layout layout;
+		return layout;
+	}
+
+	// per side (Figure::Cross, Figure::Circle)
+	uint16_t m_Figures[2][PADDED_LINES];
+	// pattern counts per side, feature and line, and their sums over all lines
+	uint16_t m_Counts[2][FEATURES][PADDED_LINES];
+	int m_Totals[2][FEATURES];
+
+public:
+	ThreatEvaluator()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		std::memset(m_Figures, 0, sizeof(m_Figures));
+		std::memset(m_Counts, 0, sizeof(m_Counts));
+		std::memset(m_Totals, 0, sizeof(m_Totals));
+	}
+
+	// Takes over all figures of the board and counts everything from scratch.
+	template<typename BoardType>
+	void Reset(const BoardType& board)
+	{
+		static_assert(BoardType::WIDTH == W && BoardType::HEIGHT == H && BoardType::IN_A_ROW == K, "ThreatEvaluator: wrong board");
+		std::memset(m_Figures, 0, sizeof(m_Figures));
+		for (int cell = 0; cell < CELLS; cell++)
+		{
+			if (board.At(cell) != Figure::None)
+				Set(cell, board.At(cell));
+		}
+		Rescan();
+	}
+
+	// A figure was put into the cell.
+	void Play(int cell, Figure figure)
+	{
+		Set(cell, figure);
+		UpdateCell(cell);
+	}
+
+	// Puts a figure without counting anything, Rescan before asking for scores.
+	void Set(int cell, Figure figure)
+	{
+		for (int direction = 0; direction < 4; direction++)
+			m_Figures[static_cast<int>(figure)][Lines().line[cell][direction]] |= static_cast<uint16_t>(1 << Lines().bit[cell][direction]);
+	}
+
+	// The cell was emptied again, for unmaking moves in a search.
+	void Remove(int cell)
+	{
+		for (int direction = 0; direction < 4; direction++)
+		{
+			uint16_t keep = static_cast<uint16_t>(~(1 << Lines().bit[cell][direction]));
+			m_Figures[0][Lines().line[cell][direction]] &= keep;
+			m_Figures[1][Lines().line[cell][direction]] &= keep;
+		}
+		UpdateCell(cell);
+	}
+
+	// Recounts every line, with AVX2 when the build has it.
+	void Rescan()
+	{
+#ifdef __AVX2__
+		RescanWith<threat_detail::Avx2Lanes>();
+#else
+		RescanWith<threat_detail::ScalarLanes>();
+#endif
+	}
+
+	// Recounts every line one at a time, to compare against the vector path.
+	void RescanScalar()
+	{
+		RescanWith<threat_detail::ScalarLanes>();
+	}
+
+	static bool IsVectorized()
+	{
+#ifdef __AVX2__
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	Threats GetThreats(Figure side) const
+	{
+		const int* totals = m_Totals[static_cast<int>(side)];
+		Threats threats = {};
+		for (int n = 2; n <= K; n++)
+			threats.windows[n] = totals[WindowFeature(n)];
+		for (int n = 2; n < K; n++)
+			threats.open[n] = totals[OpenFeature(n)];
+		return threats;
+	}
+
+	// Threats of side minus the threats of the other side, +-WIN_SCORE once either has a line.
+	int Score(Figure side) const
+	{
+		const int* own = m_Totals[static_cast<int>(side)];
+		const int* other = m_Totals[1 - static_cast<int>(side)];
+		if (own[WindowFeature(K)] != 0)
+			return WIN_SCORE;
+		if (other[WindowFeature(K)] != 0)
+			return -WIN_SCORE;
+		// each stone more in a pattern is worth 8 times as much, open runs 4 times a window
+		int score = 0;
+		for (int n = 2; n < K; n++)
+		{
+			score += (own[WindowFeature(n)] - other[WindowFeature(n)]) * (1 << (3 * n));
+			score += (own[OpenFeature(n)] - other[OpenFeature(n)]) * (1 << (3 * n + 2));
+		}
+		return score;
+	}
+
+private:
+	template<typename Lanes>
+	void RescanWith()
+	{
+		using V = typename Lanes::Type;
+		V sums[2][FEATURES];
+		for (int side = 0; side < 2; side++)
+		{
+			for (int feature = 0; feature < FEATURES; feature++)
+				sums[side][feature] = Lanes::Zero();
+		}
+
+		for (int first = 0; first < PADDED_LINES; first += Lanes::COUNT)
+		{
+			V inside = Lanes::Load(&Lines().inside[first]);
+			V figures[2] = { Lanes::Load(&m_Figures[0][first]), Lanes::Load(&m_Figures[1][first]) };
+			for (int side = 0; side < 2; side++)
+			{
+				V windows[K + 1], open[K];
+				threat_detail::PatternKernel<Lanes, K>::Find(figures[side], figures[1 - side], inside, windows, open);
+				for (int feature = 0; feature < FEATURES; feature++)
+				{
+					V count = Lanes::PopCount(feature < K - 1 ? windows[feature + 2] : open[feature - (K - 1) + 2]);
+					Lanes::Store(&m_Counts[side][feature][first], count);
+					sums[side][feature] = Lanes::Add(sums[side][feature], count);
+				}
+			}
+		}
+
+		for (int side = 0; side < 2; side++)
+		{
+			for (int feature = 0; feature < FEATURES; feature++)
+				m_Totals[side][feature] = Lanes::Sum(sums[side][feature]);
+		}
+	}
+
+	// Recounts the four lines through the cell and moves the totals by the difference.
+	void UpdateCell(int cell)
+	{
+		using Lanes = threat_detail::ScalarLanes;
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int line = Lines().line[cell][direction];
+			Lanes::Type inside = Lines().inside[line];
+			Lanes::Type figures[2] = { m_Figures[0][line], m_Figures[1][line] };
+			for (int side = 0; side < 2; side++)
+			{
+				Lanes::Type windows[K + 1], open[K];
+				threat_detail::PatternKernel<Lanes, K>::Find(figures[side], figures[1 - side], inside, windows, open);
+				for (int feature = 0; feature < FEATURES; feature++)
+				{
+					int count = static_cast<int>(Lanes::PopCount(feature < K - 1 ? windows[feature + 2] : open[feature - (K - 1) + 2]));
+					m_Totals[side][feature] += count - m_Counts[side][feature][line];
+					m_Counts[side][feature][line] = static_cast<uint16_t>(count);
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,133 @@
+#include "TournamentRenderer.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+
+// part of a tile left empty around its board
+static const float TILE_MARGIN = 0.1f;
+
+
+TournamentRenderer::TournamentRenderer(const BoardGeometry& geometry, int cells, int max_boards)
+	: m_Geometry(geometry), m_MaxBoards(max_boards), m_CellCount(cells),
+	m_FrameUniforms(BoardRenderer::DefaultFrameUniforms()),
+	m_FrameUB(sizeof(FrameUniforms), BoardRenderer::FRAME_DATA_BINDING),
+	m_Grid(geometry.GridVertices()),
+	m_GridShader("resource/shaders/Basic.shader"),
+	m_GridTransform(1.0f),
+	m_GridStream(static_cast<int>(m_Grid.size() * sizeof(float)) * max_boards),
+	m_FigureShader("resource/shaders/Piece.shader"),
+	m_QuadVB(BoardRenderer::FIGURE_QUAD, sizeof(BoardRenderer::FIGURE_QUAD)),
+	m_FigureStream(static_cast<int>(sizeof(FigureInstance)) * cells * max_boards),
+	m_GridVertices(nullptr), m_Figures(nullptr), m_GridVertexCount(0), m_FigureCount(0), m_Columns(1)
+{
+	m_GridShader.BindUniformBlock("FrameData", BoardRenderer::FRAME_DATA_BINDING);
+	m_GridColorUniform = m_GridShader.GetUniform("u_color");
+	m_GridTransformUniform = m_GridShader.GetUniform("translation_matrix");
+	m_FigureShader.BindUniformBlock("FrameData", BoardRenderer::FRAME_DATA_BINDING);
+
+	VertexBufferLayout grid_layout;
+	grid_layout.Push<float>(3);
+	VertexBufferLayout quad_layout;
+	quad_layout.Push<float>(2);
+	VertexBufferLayout instance_layout;
+	for (int column = 0; column < 4; column++)
+		instance_layout.Push<float>(4, 1);
+	instance_layout.Push<float>(1, 1);
+	instance_layout.Push<float>(1, 1);
+	// one vertex array per segment, so the attribute offsets never have to change
+	for (int segment = 0; segment < StreamBuffer::SEGMENTS; segment++)
+	{
+		m_GridVA[segment].AddBuffer(m_GridStream.GetRendererID(), grid_layout, segment * m_GridStream.GetSegmentSize());
+		m_FigureVA[segment].AddBuffer(m_QuadVB, quad_layout);
+		m_FigureVA[segment].AddBuffer(m_FigureStream.GetRendererID(), instance_layout, segment * m_FigureStream.GetSegmentSize());
+	}
+	m_FigureVA[StreamBuffer::SEGMENTS - 1].Unbind();
+	m_QuadVB.Unbind();
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+}
+
+bool TournamentRenderer::BeginFrame(int board_count, int figure_count)
+{
+	m_Columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(board_count))));
+	if (m_Columns < 1)
+		m_Columns = 1;
+	m_GridVertexCount = 0;
+	m_FigureCount = 0;
+
+	// the only allocation of the frame in each stream, so both start their segment (offset 0)
+	// and the vertex array of the segment points right at them
+	int offset = 0;
+	m_GridStream.Begin();
+	m_FigureStream.Begin();
+	m_GridVertices = static_cast<float*>(m_GridStream.Allocate(board_count * static_cast<int>(m_Grid.size() * sizeof(float)), offset));
+	m_Figures = static_cast<FigureInstance*>(m_FigureStream.Allocate(figure_count * static_cast<int>(sizeof(FigureInstance)), offset));
+	if (m_GridVertices == nullptr || m_Figures == nullptr)
+	{
+		std::cout << "Warning: can't stream " << board_count << " boards" << std::endl;
+		m_GridStream.End();
+		m_FigureStream.End();
+		return false;
+	}
+	return true;
+}
+
+glm::mat4 TournamentRenderer::TileTransform(int index) const
+{
+	float tile_size = 2.0f / m_Columns;
+	glm::vec3 center(-1.0f + (index % m_Columns + 0.5f) * tile_size, 1.0f - (index / m_Columns + 0.5f) * tile_size, 0.0f);
+	glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), center);
+	return glm::scale(translation_matrix, glm::vec3(0.5f * tile_size * (1.0f - TILE_MARGIN)));
+}
+
+void TournamentRenderer::AddGrid(const glm::mat4& tile)
+{
+	// the mapping may be write-combined memory: written front to back, never read
+	float* out = m_GridVertices + m_GridVertexCount * 3;
+	for (size_t i = 0; i < m_Grid.size(); i += 3)
+	{
+		glm::vec4 vertex = tile * glm::vec4(m_Grid[i], m_Grid[i + 1], m_Grid[i + 2], 1.0f);
+		*out++ = vertex.x;
+		*out++ = vertex.y;
+		*out++ = vertex.z;
+	}
+	m_GridVertexCount += static_cast<int>(m_Grid.size()) / 3;
+}
+
+void TournamentRenderer::AddFigure(const glm::mat4& tile, int cell, bool cross, bool winning)
+{
+	float palette = static_cast<float>(winning ? PALETTE_WINNING : (cross ? PALETTE_CROSS : PALETTE_CIRCLE));
+	m_Figures[m_FigureCount++] = { tile * BoardRenderer::FigureTransform(m_Geometry, cell), palette, cross ? 0.0f : 1.0f };
+}
+
+void TournamentRenderer::EndFrame(Renderer& renderer, int width, int height, const FrameBuffer* target)
+{
+	m_GridStream.End();
+	m_FigureStream.End();
+	m_FrameUB.SetData(&m_FrameUniforms, sizeof(m_FrameUniforms));
+
+	if (target != nullptr)
+		target->Bind();
+	else
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GLCall(glViewport(0, 0, width, height));
+	}
+	renderer.Clear();
+	// thinner lines than a single board, there are many of them on a tile a fraction of the size
+	if (m_GridVertexCount > 0)
+		renderer.Submit({ &m_GridShader, &m_GridVA[m_GridStream.GetSegment()], GL_LINES, m_GridVertexCount, 1, 1.0f,
+			m_GridColorUniform, &m_FrameUniforms.palette[PALETTE_GRID], m_GridTransformUniform, &m_GridTransform });
+	if (m_FigureCount > 0)
+		renderer.Submit({ &m_FigureShader, &m_FigureVA[m_FigureStream.GetSegment()], GL_TRIANGLE_STRIP, 4,
+			m_FigureCount, 0.0f, Uniform(), nullptr, Uniform(), nullptr });
+	renderer.Flush();
+
+	m_GridStream.Fence();
+	m_FigureStream.Fence();
+	m_GridVertices = nullptr;
+	m_Figures = nullptr;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Renderer.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "FrameBuffer.h"
+#include "UniformBuffer.h"
+#include "StreamBuffer.h"
+#include "BoardRenderer.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+
+
+// Draws many boards tiled over the target: every grid line in one draw call and every
+// figure in one instanced call, whatever the number of boards. Everything is rewritten
+// each frame into triple-buffered StreamBuffers, nothing is cached between frames.
+class TournamentRenderer
+{
+private:
+	BoardGeometry m_Geometry;
+	int m_MaxBoards;
+	int m_CellCount;
+	FrameUniforms m_FrameUniforms;
+	UniformBuffer m_FrameUB;
+
+	// the lines of one board, the stream gets a copy moved onto each tile
+	std::vector<float> m_Grid;
+	Shader m_GridShader;
+	Uniform m_GridColorUniform;
+	Uniform m_GridTransformUniform;
+	glm::mat4 m_GridTransform;
+	StreamBuffer m_GridStream;
+	VertexArray m_GridVA[StreamBuffer::SEGMENTS];
+
+	Shader m_FigureShader;
+	VertexBuffer m_QuadVB;
+	StreamBuffer m_FigureStream;
+	VertexArray m_FigureVA[StreamBuffer::SEGMENTS];
+
+	// between BeginFrame and EndFrame: where this frame's vertices go and how many there are
+	float* m_GridVertices;
+	FigureInstance* m_Figures;
+	int m_GridVertexCount;
+	int m_FigureCount;
+	int m_Columns;
+
+public:
+	// cells: of one board, max_boards: the most boards one Render draws
+	TournamentRenderer(const BoardGeometry& geometry, int cells, int max_boards);
+
+	// Draw the boards into target, or into the window when target is nullptr. Boards
+	// beyond max_boards are left out. Flushes the renderer; call Renderer::BeginFrame before.
+	template<typename BoardType>
+	void Render(Renderer& renderer, const std::vector<BoardType>& boards, int width, int height, const FrameBuffer* target = nullptr);
+
+private:
+	// false if nothing can be drawn this frame
+	bool BeginFrame(int board_count, int figure_count);
+	// where board number index goes: tiles of equal size, row by row from the top-left
+	glm::mat4 TileTransform(int index) const;
+	void AddGrid(const glm::mat4& tile);
+	void AddFigure(const glm::mat4& tile, int cell, bool cross, bool winning);
+	void EndFrame(Renderer& renderer, int width, int height, const FrameBuffer* target);
+};
+
+
+template<typename BoardType>
+void TournamentRenderer::Render(Renderer& renderer, const std::vector<BoardType>& boards, int width, int height, const FrameBuffer* target)
+{
+	int board_count = static_cast<int>(boards.size()) < m_MaxBoards ? static_cast<int>(boards.size()) : m_MaxBoards;
+	// every move left a figure, so the stream knows how much room to hand out
+	int figure_count = 0;
+	for (int i = 0; i < board_count; i++)
+		figure_count += boards[i].MoveCount();
+	if (!BeginFrame(board_count, figure_count))
+		return;
+	for (int i = 0; i < board_count; i++)
+	{
+		const BoardType& board = boards[i];
+		glm::mat4 tile = TileTransform(i);
+		AddGrid(tile);
+		for (int cell = 0; cell < BoardType::CELLS; cell++)
+		{
+			Figure figure = board.At(cell);
+			if (figure != Figure::None)
+				AddFigure(tile, cell, figure == Figure::Cross, board.IsOnWinningLine(cell));
+		}
+	}
+	EndFrame(renderer, width, height, target);
+}
@@ -0,0 +1,47 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include <utility>
+
+UniformBuffer::UniformBuffer(int size, unsigned int binding)
+	: m_Binding(binding), m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Binding(other.m_Binding), m_Size(other.m_Size)
+{
+	other.m_RendererID = 0;
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Binding, other.m_Binding);
+	std::swap(m_Size, other.m_Size);
+	return *this;
+}
+
+void UniformBuffer::SetData(const void* data, int size)
+{
+	if (size > m_Size)
+	{
+		std::cout << "Warning: " << size << " bytes don't fit into a uniform buffer of " << m_Size << std::endl;
+		size = m_Size;
+	}
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data));
+	// renderers may share the binding point, the last one uploaded is the one the shaders read
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID));
+	GLState::CountUniformUpload();
+}
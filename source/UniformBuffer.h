@@ -0,0 +1,27 @@
+#pragma once
+
+
+// A uniform buffer object attached to a binding point. Shaders read it through
+// a uniform block connected to the same point with Shader::BindUniformBlock.
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Binding;
+	int m_Size;
+
+public:
+	UniformBuffer(int size, unsigned int binding);
+	~UniformBuffer();
+
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	// Upload the block in one glBufferSubData, data must follow the std140 layout of the block.
+	void SetData(const void* data, int size);
+
+	inline unsigned int GetBinding() const { return m_Binding; }
+	inline int GetSize() const { return m_Size; }
+};
@@ -1,39 +1,66 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
+#include "GLState.h"
+
+#include <cstdint>
+#include <utility>
 
 VertexArray::VertexArray()
+	: m_AttributeCount(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 	
 }
 
 VertexArray::~VertexArray()
 {
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	GLState::VertexArrayDeleted(m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_AttributeCount(other.m_AttributeCount)
+{
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_AttributeCount, other.m_AttributeCount);
+	return *this;
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLState::BindVertexArray(0);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	AddBuffer(vb.GetRendererID(), layout, 0);
+}
+
+void VertexArray::AddBuffer(unsigned int buffer, const VertexBufferLayout& layout, unsigned int offset)
 {
 	Bind();
-	vb.Bind();
+	GLState::BindArrayBuffer(buffer);
 	const auto& elements = layout.GetElements();
-	unsigned int offset = 0;
-	for (int i = 0; i < elements.size(); i++)
+	for (const auto& element : elements)
 	{
-		const auto& element = elements[i];
-		GLCall(glVertexAttribPointer(i, element.size, element.type, element.normalized, layout.GetStride(), reinterpret_cast<const void*>(offset)));
-		GLCall(glEnableVertexAttribArray(i));
+		unsigned int index = m_AttributeCount++;
+		GLCall(glVertexAttribPointer(index, element.size, element.type, element.normalized, layout.GetStride(), reinterpret_cast<const void*>(static_cast<uintptr_t>(offset))));
+		GLCall(glEnableVertexAttribArray(index));
+		if (element.divisor != 0)
+		{
+			GLCall(glVertexAttribDivisor(index, element.divisor));
+		}
 		offset += element.size * VertexBufferElement::GetSizeOfType(element.type);
 	}
 	
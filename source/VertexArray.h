@@ -7,15 +7,27 @@ class VertexBufferLayout;
 class VertexArray
 {
 private:
-	unsigned int m_RendererID;;
+	unsigned int m_RendererID;
+	// attributes are numbered on from one buffer to the next
+	unsigned int m_AttributeCount;
 
 public:
 	VertexArray();
 	~VertexArray();
 
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 
+	// the buffer's attributes get the next free locations
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// the same for the buffer with this id, its vertices start offset bytes in (e.g. a StreamBuffer segment)
+	void AddBuffer(unsigned int buffer, const VertexBufferLayout& layout, unsigned int offset);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
 
@@ -1,25 +1,59 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
+
+#include <utility>
 
 // Vertex BUFFER it's a block of memory (buffer) where we can push bites (tell GPU to read this data).
 VertexBuffer::VertexBuffer(const void* data, int size)
+	: VertexBuffer(data, size, GL_STATIC_DRAW) {}
+
+VertexBuffer::VertexBuffer(const void* data, int size, unsigned int usage)
+	: m_Usage(usage), m_Size(size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GLState::BindArrayBuffer(m_RendererID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::ArrayBufferDeleted(m_RendererID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Usage(other.m_Usage), m_Size(other.m_Size)
+{
+	other.m_RendererID = 0;
+}
+
+// swap: other's destructor deletes what this buffer held
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Usage, other.m_Usage);
+	std::swap(m_Size, other.m_Size);
+	return *this;
 }
 
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLState::BindArrayBuffer(m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLState::BindArrayBuffer(0);
+}
+
+void VertexBuffer::SetData(const void* data, int size)
+{
+	Bind();
+	// grow to twice the size, so a slowly growing buffer isn't reallocated every time
+	if (size > m_Size)
+		m_Size = size * 2;
+	// orphan the old storage: the driver hands out fresh memory instead of waiting for the GPU to finish with it
+	GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, m_Usage));
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
 }
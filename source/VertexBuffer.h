@@ -5,12 +5,28 @@ class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Usage;
+	int m_Size;
 
 public:
 	VertexBuffer(const void* data, int size);
+	// usage: GL_STATIC_DRAW for data that is uploaded once, GL_DYNAMIC_DRAW for data that changes
+	VertexBuffer(const void* data, int size, unsigned int usage);
 	~VertexBuffer();
 
+	// GL objects can only be handed on, the moved-from buffer is left with id 0, which GL ignores
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
+
+	// Replace the contents, the buffer grows if the data doesn't fit.
+	// Leaves the buffer bound to GL_ARRAY_BUFFER.
+	void SetData(const void* data, int size);
+	inline int GetSize() const { return m_Size; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
 
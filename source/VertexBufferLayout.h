@@ -8,6 +8,8 @@ struct VertexBufferElement
 	unsigned int size;
 	unsigned int type;
 	bool normalized;
+	// 0: one value per vertex, n: one value per n instances (instanced drawing)
+	unsigned int divisor;
 
 	static unsigned int GetSizeOfType(int type)
 	{
@@ -33,33 +35,35 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {}
 
+	// divisor 1 makes the attribute advance once per instance instead of once per vertex
 	template<typename T>
-	void Push(unsigned int size)
+	void Push(unsigned int size, unsigned int divisor = 0)
 	{
-		static_assert(0, "ERROR: You can use only types that are listed below. VertexBufferLayout.h");
+		static_assert(sizeof(T) == 0, "ERROR: You can use only types that are listed below. VertexBufferLayout.h");
 	}
 
-	template<>
-	void Push<float>(unsigned int size)
-	{
-		m_Elements.push_back({ size, GL_FLOAT, GL_FALSE });
-		m_Stride += size * VertexBufferElement::GetSizeOfType(GL_FLOAT);
-	}
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+};
 
-	template<>
-	void Push<unsigned int>(unsigned int size)
-	{
-		m_Elements.push_back({ size, GL_UNSIGNED_INT, GL_FALSE });
-		m_Stride += size * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
-	}
 
-	template<>
-	void Push<unsigned char>(unsigned int size)
-	{
-		m_Elements.push_back({ size, GL_UNSIGNED_BYTE, GL_TRUE });
-		m_Stride += size * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
-	}
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int size, unsigned int divisor)
+{
+	m_Elements.push_back({ size, GL_FLOAT, GL_FALSE, divisor });
+	m_Stride += size * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
-	inline const unsigned int GetStride() const { return m_Stride; }
-};
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int size, unsigned int divisor)
+{
+	m_Elements.push_back({ size, GL_UNSIGNED_INT, GL_FALSE, divisor });
+	m_Stride += size * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int size, unsigned int divisor)
+{
+	m_Elements.push_back({ size, GL_UNSIGNED_BYTE, GL_TRUE, divisor });
+	m_Stride += size * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+}
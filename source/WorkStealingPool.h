@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Thread pool for recursive work: a task may submit more tasks, they go onto the queue of
+// the worker running it. Workers take their own newest task first (the one that is still
+// hot in the cache) and, when they run dry, steal the oldest task of another worker, which
+// is the biggest piece of work left there. No GL dependency, for the batch tools.
+class WorkStealingPool
+{
+public:
+	// worker: index of the thread running the task, for per-thread results
+	using Task = std::function<void(int worker)>;
+
+private:
+	// allocated one by one and padded, so the queues the workers lock all the time don't share a cache line
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		char padding[64];
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_Queues;
+	std::vector<std::thread> m_Threads;
+	// tasks in the queues, and tasks submitted but not finished
+	std::atomic<long long> m_Queued;
+	std::atomic<long long> m_Pending;
+	std::atomic<unsigned int> m_NextQueue;
+	bool m_Stop;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_AllDone;
+
+public:
+	// threads: 0 for every hardware thread
+	explicit WorkStealingPool(int threads = 0)
+		: m_Queued(0), m_Pending(0), m_NextQueue(0), m_Stop(false)
+	{
+		if (threads <= 0)
+			threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+		for (int i = 0; i < threads; i++)
+			m_Queues.emplace_back(new Queue());
+		for (int i = 0; i < threads; i++)
+			m_Threads.emplace_back(&WorkStealingPool::Work, this, i);
+	}
+
+	~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop = true;
+		}
+		m_WorkReady.notify_all();
+		for (std::thread& thread : m_Threads)
+			thread.join();
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	// From a task: onto the queue of its worker. From anywhere else: the queues take turns.
+	void Submit(Task task)
+	{
+		int worker = CurrentWorker();
+		Queue& queue = *m_Queues[worker != -1 ? worker : m_NextQueue++ % m_Queues.size()];
+		m_Pending++;
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		m_Queued++;
+		// taking the lock orders this with a worker that is just going to sleep
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+		}
+		m_WorkReady.notify_one();
+	}
+
+	// Block until every task has finished, including the ones they submitted. Not from a task.
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_AllDone.wait(lock, [this] { return m_Pending == 0; });
+	}
+
+	inline int GetThreadCount() const { return static_cast<int>(m_Threads.size()); }
+
+private:
+	// the worker index of this pool running on the calling thread, -1 outside of it
+	int CurrentWorker() const
+	{
+		const WorkerId& id = ThisWorker();
+		return id.pool == this ? id.index : -1;
+	}
+
+	struct WorkerId
+	{
+		const WorkStealingPool* pool;
+		int index;
+	};
+
+	static WorkerId& ThisWorker()
+	{
+		static thread_local WorkerId id = { nullptr, -1 };
+		return id;
+	}
+
+	bool Take(int worker, Task& task)
+	{
+		// own queue from the back
+		{
+			Queue& queue = *m_Queues[worker];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				return true;
+			}
+		}
+		// the others from the front, starting with the next worker so the thieves spread out
+		for (size_t i = 1; i < m_Queues.size(); i++)
+		{
+			Queue& queue = *m_Queues[(worker + i) % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Work(int worker)
+	{
+		ThisWorker() = { this, worker };
+		Task task;
+		while (true)
+		{
+			if (Take(worker, task))
+			{
+				m_Queued--;
+				task(worker);
+				task = nullptr;
+				if (--m_Pending == 0)
+				{
+					std::lock_guard<std::mutex> lock(m_SleepMutex);
+					m_AllDone.notify_all();
+				}
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_WorkReady.wait(lock, [this] { return m_Stop || m_Queued > 0; });
+			if (m_Stop)
+				return;
+		}
+	}
+};
@@ -0,0 +1,110 @@
+// Writes every canonical position of a board (up to symmetry) with its game value
+// and best move into a book file that the game maps at startup.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -Isource tools/BookGenerator.cpp source/OpeningBook.cpp source/MappedFile.cpp -o BookGenerator
+// Usage:
+//   BookGenerator [output] [board: 3x3x3 | 4x4x3 | 4x4x4] [max stones, partial book]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <chrono>
+
+#include "Board.h"
+#include "Solver.h"
+#include "Symmetry.h"
+#include "OpeningBook.h"
+
+
+template<typename BoardType>
+class BookGenerator
+{
+private:
+	using Symmetries = Symmetry<BoardType::WIDTH, BoardType::HEIGHT>;
+
+	Solver<BoardType> m_Solver;
+	int m_MaxStones;
+	std::unordered_set<uint64_t> m_Visited;
+	std::vector<BookEntry> m_Entries;
+
+public:
+	BookGenerator(int max_stones, int table_bits)
+		: m_Solver(table_bits), m_MaxStones(max_stones) {}
+
+	const std::vector<BookEntry>& Generate()
+	{
+		Visit(BoardType());
+		return m_Entries;
+	}
+
+	const Solver<BoardType>& GetSolver() const { return m_Solver; }
+
+private:
+	void Visit(const BoardType& board)
+	{
+		if (board.MoveCount() > m_MaxStones)
+			return;
+		int symmetry;
+		uint64_t key = Symmetries::CanonicalKey(board, &symmetry);
+		if (!m_Visited.insert(key).second)
+			return;
+
+		BookEntry entry;
+		entry.key = key;
+		entry.value = static_cast<int8_t>(m_Solver.Solve(board));
+		entry.best_move = -1;
+		if (!board.IsOver())
+			entry.best_move = static_cast<int8_t>(Symmetries::Apply(symmetry, m_Solver.BestMove(board)));
+		m_Entries.push_back(entry);
+
+		if (board.IsOver())
+			return;
+		for (int cell = 0; cell < BoardType::CELLS; cell++)
+		{
+			BoardType child = board;
+			if (child.Play(cell))
+				Visit(child);
+		}
+	}
+};
+
+
+template<typename BoardType>
+int Generate(const std::string& output, int max_stones, int table_bits)
+{
+	auto start = std::chrono::steady_clock::now();
+	BookGenerator<BoardType> generator(max_stones, table_bits);
+	const std::vector<BookEntry>& entries = generator.Generate();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	uint8_t flags = max_stones >= BoardType::CELLS ? OpeningBook::FLAG_COMPLETE : 0;
+	if (!OpeningBook::Write(output, BoardType::WIDTH, BoardType::HEIGHT, BoardType::IN_A_ROW, max_stones, flags, entries))
+	{
+		std::cout << "Failed to write " << output << std::endl;
+		return 1;
+	}
+	const auto& statistics = generator.GetSolver().GetStatistics();
+	std::cout << output << ": " << entries.size() << " positions" << (flags & OpeningBook::FLAG_COMPLETE ? "" : " (partial)")
+		<< ", " << statistics.nodes << " nodes searched, " << statistics.HitRate() * 100.0 << "% table hits, "
+		<< elapsed.count() << " s" << std::endl;
+	return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	std::string output = argc > 1 ? argv[1] : "resource/book/3x3x3.book";
+	std::string board = argc > 2 ? argv[2] : "3x3x3";
+	int max_stones = argc > 3 ? std::stoi(argv[3]) : 64;
+
+	if (board == "3x3x3")
+		return Generate<Board<3, 3, 3>>(output, max_stones, 16);
+	if (board == "4x4x3")
+		return Generate<Board<4, 4, 3>>(output, max_stones, 22);
+	if (board == "4x4x4")
+		return Generate<Board<4, 4, 4>>(output, max_stones, 24);
+	std::cout << "Unknown board " << board << ", expected 3x3x3, 4x4x3 or 4x4x4" << std::endl;
+	return 1;
+}
@@ -0,0 +1,173 @@
+// Microbenchmark: move + win check throughput of GameState against the
+// map-based Position_Cache/WinCheck path that Application.cpp used before.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -Isource tools/GameStateBenchmark.cpp -o GameStateBenchmark
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "GameState.h"
+
+
+namespace map_based
+{
+	// stand-in for glm::vec3 so the tool doesn't depend on glm
+	struct Vec3
+	{
+		float x, y, z;
+	};
+
+	std::array<Vec3, 9> adjusted_positions = { {
+		{  0.0f,   0.0f,  0.0f },
+		{  0.67f,  0.0f,  0.0f },
+		{ -0.67f,  0.0f,  0.0f },
+		{  0.0f,   0.67f, 0.0f },
+		{  0.0f,  -0.67f, 0.0f },
+		{  0.67f,  0.67f, 0.0f },
+		{ -0.67f,  0.67f, 0.0f },
+		{  0.67f, -0.67f, 0.0f },
+		{ -0.67f, -0.67f, 0.0f }
+	} };
+	// GameState cell (row by row from the top-left) -> index into adjusted_positions
+	const int FROM_CELL[9] = { 6, 3, 5, 2, 0, 1, 8, 4, 7 };
+
+	std::unordered_map<Vec3*, int> Position_Cache;
+	bool win = false;
+	int winning_figure = -1;
+	std::array<int, 3> winning_positions;
+
+	// copy of the old WinCheck from Application.cpp
+	void WinCheck(int mod, int i)
+	{
+		int matches_horizontally = 0, matches_vertically = 0,
+			matches_rl_diagonally = 0, matches_lr_diagonally = 0;
+		std::array<int, 3> winning_horizontally, winning_vertically,
+							winning_rl_diagonally, winning_lr_diagonally;
+
+		for (int j = 0; j < 9; j++)
+		{
+			if (Position_Cache[&adjusted_positions[i]] != 0 && Position_Cache[&adjusted_positions[j]] != 0)
+			{
+				if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
+					&& (adjusted_positions[i].y == adjusted_positions[j].y))
+				{
+					winning_horizontally[matches_horizontally] = Position_Cache[&adjusted_positions[j]] - 2;
+					matches_horizontally++;
+					if (matches_horizontally == 3)
+					{
+						winning_positions = winning_horizontally;
+						win = true;
+						break;
+					}
+				}
+				if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
+					&& (adjusted_positions[i].x == adjusted_positions[j].x))
+				{
+					winning_vertically[matches_vertically] = Position_Cache[&adjusted_positions[j]] - 2;
+					matches_vertically++;
+					if (matches_vertically == 3)
+					{
+						winning_positions = winning_vertically;
+						win = true;
+						break;
+					}
+				}
+				if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
+					&& (adjusted_positions[j].x == -adjusted_positions[j].y))
+				{
+					winning_lr_diagonally[matches_lr_diagonally] = Position_Cache[&adjusted_positions[j]] - 2;
+					matches_lr_diagonally++;
+					if (matches_lr_diagonally == 3)
+					{
+						winning_positions = winning_lr_diagonally;
+						win = true;
+						break;
+					}
+				}
+				if ((Position_Cache[&adjusted_positions[i]] % 2 == mod && Position_Cache[&adjusted_positions[j]] % 2 == mod)
+					&& (adjusted_positions[j].x == adjusted_positions[j].y))
+				{
+					winning_rl_diagonally[matches_rl_diagonally] = Position_Cache[&adjusted_positions[j]] - 2;
+					matches_rl_diagonally++;
+					if (matches_rl_diagonally == 3)
+					{
+						winning_positions = winning_rl_diagonally;
+						win = true;
+						break;
+					}
+				}
+			}
+		}
+		if (win == true)
+			winning_figure = mod;
+	}
+
+	// returns the number of moves played
+	int PlayGame(const std::array<int, 9>& cells)
+	{
+		Position_Cache.clear();
+		win = false;
+		winning_figure = -1;
+		int click_count = 0;
+		for (; click_count < 9 && !win; click_count++)
+		{
+			int i = FROM_CELL[cells[click_count]];
+			Position_Cache[&adjusted_positions[i]] = click_count + 2;
+			WinCheck(0, i);
+			if (win != true)
+				WinCheck(1, i);
+		}
+		return click_count;
+	}
+}
+
+
+int PlayGame(const std::array<int, 9>& cells)
+{
+	GameState state;
+	int moves = 0;
+	while (!state.IsOver())
+		state.Play(cells[moves++]);
+	return moves;
+}
+
+
+template<typename Function>
+void Measure(const char* name, const std::vector<std::array<int, 9>>& games, Function play)
+{
+	auto start = std::chrono::steady_clock::now();
+	long long moves = 0;
+	for (const auto& game : games)
+		moves += play(game);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ": " << moves << " moves in " << elapsed.count() << " s, "
+		<< static_cast<long long>(moves / elapsed.count()) << " moves/s" << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+	int number_of_games = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+	// random move orders, the same for both paths
+	std::mt19937 random(12345);
+	std::vector<std::array<int, 9>> games(number_of_games);
+	for (auto& game : games)
+	{
+		for (int i = 0; i < 9; i++)
+			game[i] = i;
+		std::shuffle(game.begin(), game.end(), random);
+	}
+
+	Measure("Position_Cache + WinCheck", games, map_based::PlayGame);
+	Measure("GameState bitboard       ", games, PlayGame);
+	return 0;
+}
@@ -0,0 +1,428 @@
+// Load generator for tools/MatchServer.cpp: spreads many concurrent games over a few
+// connections and plays random moves in all of them as fast as the server answers, each game
+// waiting for its reply before the next move. Checks every outcome the server reports against
+// its own copy of the board and reports moves/s and the latency of moves. Linux only.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -Isource tools/MatchClient.cpp -o MatchClient
+// Usage:
+//   MatchClient [options]
+//     --board 3x3x3 | 15x15x5   must match the server (default 3x3x3)
+//     --host ADDRESS            (default 127.0.0.1)
+//     --port N                  (default 7777)
+//     --connections N           (default 8)
+//     --games N                 concurrent games over all connections (default 10000)
+//     --seconds N               how long to play (default 10)
+//     --mode bot | local        the server plays circles, or the client plays both sides (default bot)
+//     --seed N                  (default 1)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "Agent.h"
+#include "MatchProtocol.h"
+
+
+struct Options
+{
+	std::string board = "3x3x3";
+	std::string host = "127.0.0.1";
+	int port = 7777;
+	int connections = 8;
+	int games = 10000;
+	double seconds = 10.0;
+	std::string mode = "bot";
+	uint64_t seed = 1;
+};
+
+using Clock = std::chrono::steady_clock;
+
+
+template<typename BoardType>
+struct ClientGame
+{
+	BoardType board;
+	uint32_t game = 0;
+	int fd = -1;
+	// a request is on its way, and when it was sent
+	bool waiting = false;
+	Clock::time_point sent;
+};
+
+struct ClientConnection
+{
+	char partial[sizeof(MatchMessage)];
+	int partial_size = 0;
+	std::vector<char> out;
+	bool writing = false;
+};
+
+
+template<typename BoardType>
+class LoadClient
+{
+private:
+	Options m_Options;
+	uint8_t m_Mode;
+	int m_Epoll;
+	std::vector<int> m_Fds;
+	std::vector<ClientConnection> m_Connections;  // by file descriptor
+	std::vector<ClientGame<BoardType>> m_Games;   // the tag of a game is its index
+	RandomAgent<BoardType> m_Agent;
+	// microseconds from sending a move to its reply
+	std::vector<uint32_t> m_Latencies;
+	int m_Waiting;
+	bool m_Stopping;
+	long long m_Moves;
+	long long m_Finished;
+	long long m_Errors;
+	long long m_Mismatches;
+	// the server closed a connection before the run was over
+	bool m_Disconnected;
+
+public:
+	LoadClient(const Options& options, uint8_t mode)
+		: m_Options(options), m_Mode(mode), m_Epoll(-1), m_Games(options.games), m_Agent(options.seed),
+		m_Waiting(0), m_Stopping(false), m_Moves(0), m_Finished(0), m_Errors(0), m_Mismatches(0), m_Disconnected(false)
+	{
+		m_Latencies.reserve(1 << 20);
+	}
+
+	~LoadClient()
+	{
+		for (int fd : m_Fds)
+			close(fd);
+		if (m_Epoll != -1)
+			close(m_Epoll);
+	}
+
+	bool Connect()
+	{
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<uint16_t>(m_Options.port));
+		if (inet_pton(AF_INET, m_Options.host.c_str(), &addr.sin_addr) != 1)
+		{
+			std::cout << "Bad address " << m_Options.host << std::endl;
+			return false;
+		}
+		m_Epoll = epoll_create1(0);
+		for (int i = 0; i < m_Options.connections; i++)
+		{
+			int fd = socket(AF_INET, SOCK_STREAM, 0);
+			if (fd == -1 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+			{
+				std::cout << "Can't connect to " << m_Options.host << ":" << m_Options.port << ": " << std::strerror(errno) << std::endl;
+				if (fd != -1)
+					close(fd);
+				return false;
+			}
+			int on = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+			m_Fds.push_back(fd);
+			if (static_cast<size_t>(fd) >= m_Connections.size())
+				m_Connections.resize(fd + 1);
+			epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+			epoll_ctl(m_Epoll, EPOLL_CTL_ADD, fd, &event);
+		}
+		return true;
+	}
+
+	void Run()
+	{
+		for (size_t i = 0; i < m_Games.size(); i++)
+		{
+			m_Games[i].fd = m_Fds[i % m_Fds.size()];
+			Request(static_cast<uint32_t>(i), { MSG_CREATE, m_Mode, 0, 0, static_cast<uint32_t>(i) });
+		}
+		FlushAll();
+
+		const int MAX_EVENTS = 64;
+		epoll_event events[MAX_EVENTS];
+		std::vector<char> buffer(1 << 16);
+		Clock::time_point start = Clock::now();
+		Clock::time_point stop = start + std::chrono::microseconds(static_cast<long long>(m_Options.seconds * 1e6));
+		// after the time is up, the requests on their way get a moment to come back
+		Clock::time_point give_up = stop + std::chrono::seconds(2);
+		while (true)
+		{
+			Clock::time_point now = Clock::now();
+			if (now >= stop)
+				m_Stopping = true;
+			if ((m_Stopping && m_Waiting == 0) || now >= give_up)
+				break;
+			int count = epoll_wait(m_Epoll, events, MAX_EVENTS, 100);
+			for (int i = 0; i < count; i++)
+			{
+				int fd = events[i].data.fd;
+				if (events[i].events & EPOLLOUT)
+					Flush(fd);
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				{
+					if (!Read(fd, buffer))
+					{
+						std::cout << "The server closed the connection" << std::endl;
+						m_Disconnected = true;
+						break;
+					}
+				}
+			}
+			// what was measured up to here is still reported, the run counts as failed
+			if (m_Disconnected)
+				break;
+			FlushAll();
+		}
+		std::chrono::duration<double> elapsed = Clock::now() - start;
+		Report(elapsed.count());
+	}
+
+private:
+	bool Read(int fd, std::vector<char>& buffer)
+	{
+		ClientConnection& connection = m_Connections[fd];
+		std::memcpy(buffer.data(), connection.partial, connection.partial_size);
+		ssize_t received = recv(fd, buffer.data() + connection.partial_size, buffer.size() - connection.partial_size, 0);
+		if (received < 0)
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		if (received == 0)
+			return false;
+		size_t size = connection.partial_size + static_cast<size_t>(received);
+		size_t offset = 0;
+		for (; offset + sizeof(MatchMessage) <= size; offset += sizeof(MatchMessage))
+		{
+			MatchMessage message;
+			std::memcpy(&message, buffer.data() + offset, sizeof(message));
+			Handle(message);
+		}
+		connection.partial_size = static_cast<int>(size - offset);
+		std::memcpy(connection.partial, buffer.data() + offset, connection.partial_size);
+		return true;
+	}
+
+	void Handle(const MatchMessage& message)
+	{
+		if (message.tag >= m_Games.size())
+		{
+			m_Errors++;
+			return;
+		}
+		uint32_t tag = message.tag;
+		ClientGame<BoardType>& game = m_Games[tag];
+		switch (message.type)
+		{
+		case MSG_CREATE | MSG_REPLY:
+			Answered(game);
+			game.game = message.game;
+			Move(tag);
+			return;
+		case MSG_MOVE | MSG_REPLY:
+			m_Latencies.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - game.sent).count()));
+			Answered(game);
+			Played(tag, message);
+			// with the bot, its answer is on the way
+			if (game.board.IsOver() || m_Mode == MODE_LOCAL)
+				Continue(tag);
+			return;
+		case MSG_OPPONENT_MOVE:
+			Played(tag, message);
+			Continue(tag);
+			return;
+		case MSG_RESET | MSG_REPLY:
+			Answered(game);
+			game.board = BoardType();
+			Move(tag);
+			return;
+		case MSG_ERROR:
+			if (m_Errors++ < 10)
+				std::cout << "Error " << static_cast<int>(message.status) << " in game " << tag << std::endl;
+			Answered(game);
+			return;
+		default:
+			m_Errors++;
+		}
+	}
+
+	// the reply to the game's request came
+	void Answered(ClientGame<BoardType>& game)
+	{
+		if (game.waiting)
+		{
+			game.waiting = false;
+			m_Waiting--;
+		}
+	}
+
+	// follow a move on the own board, the outcome has to be the server's
+	void Played(uint32_t tag, const MatchMessage& message)
+	{
+		ClientGame<BoardType>& game = m_Games[tag];
+		game.board.Play(message.cell);
+		m_Moves++;
+		if (OutcomeOf(game.board) != message.status)
+			m_Mismatches++;
+	}
+
+	// the next move, or a new game once this one is over
+	void Continue(uint32_t tag)
+	{
+		ClientGame<BoardType>& game = m_Games[tag];
+		if (!game.board.IsOver())
+		{
+			Move(tag);
+			return;
+		}
+		m_Finished++;
+		if (!m_Stopping)
+			Request(tag, { MSG_RESET, 0, 0, game.game, tag });
+	}
+
+	void Move(uint32_t tag)
+	{
+		ClientGame<BoardType>& game = m_Games[tag];
+		if (m_Stopping)
+			return;
+		int cell = m_Agent.ChooseMove(game.board);
+		Request(tag, { MSG_MOVE, 0, static_cast<uint16_t>(cell), game.game, tag });
+	}
+
+	void Request(uint32_t tag, const MatchMessage& message)
+	{
+		ClientGame<BoardType>& game = m_Games[tag];
+		std::vector<char>& out = m_Connections[game.fd].out;
+		const char* bytes = reinterpret_cast<const char*>(&message);
+		out.insert(out.end(), bytes, bytes + sizeof(message));
+		game.waiting = true;
+		game.sent = Clock::now();
+		m_Waiting++;
+	}
+
+	void FlushAll()
+	{
+		for (int fd : m_Fds)
+		{
+			if (!m_Connections[fd].writing)
+				Flush(fd);
+		}
+	}
+
+	void Flush(int fd)
+	{
+		ClientConnection& connection = m_Connections[fd];
+		size_t sent = 0;
+		while (sent < connection.out.size())
+		{
+			ssize_t result = send(fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+			sent += static_cast<size_t>(result);
+		}
+		connection.out.erase(connection.out.begin(), connection.out.begin() + sent);
+		bool writing = !connection.out.empty();
+		if (writing != connection.writing)
+		{
+			epoll_event event = {};
+			event.events = EPOLLIN | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+			event.data.fd = fd;
+			epoll_ctl(m_Epoll, EPOLL_CTL_MOD, fd, &event);
+			connection.writing = writing;
+		}
+	}
+
+	void Report(double seconds)
+	{
+		std::cout << m_Games.size() << " games over " << m_Fds.size() << " connections (" << m_Options.mode << "), "
+			<< seconds << " s: " << m_Moves << " moves, " << static_cast<long long>(m_Moves / seconds) << " moves/s, "
+			<< m_Finished << " games finished" << std::endl;
+		if (!m_Latencies.empty())
+		{
+			std::sort(m_Latencies.begin(), m_Latencies.end());
+			auto percentile = [this](double p) { return m_Latencies[static_cast<size_t>(p * (m_Latencies.size() - 1))]; };
+			std::cout << "move latency (us): p50 " << percentile(0.5) << ", p90 " << percentile(0.9)
+				<< ", p99 " << percentile(0.99) << ", max " << m_Latencies.back() << std::endl;
+		}
+		std::cout << m_Errors << " errors, " << m_Mismatches << " outcomes different from the server's";
+		if (m_Waiting > 0)
+			std::cout << ", " << m_Waiting << " requests unanswered";
+		if (m_Disconnected)
+			std::cout << ", aborted by the server";
+		std::cout << std::endl;
+	}
+
+public:
+	inline bool Failed() const { return m_Errors > 0 || m_Mismatches > 0 || m_Disconnected; }
+};
+
+
+template<typename BoardType>
+int Run(const Options& options)
+{
+	uint8_t mode = MODE_BOT;
+	if (options.mode == "local")
+		mode = MODE_LOCAL;
+	else if (options.mode != "bot")
+	{
+		std::cout << "Unknown mode " << options.mode << std::endl;
+		return 1;
+	}
+	if (options.connections < 1 || options.games < 1)
+	{
+		std::cout << "Needs at least one connection and one game" << std::endl;
+		return 1;
+	}
+	LoadClient<BoardType> client(options, mode);
+	if (!client.Connect())
+		return 1;
+	client.Run();
+	return client.Failed() ? 1 : 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")				options.board = value;
+		else if (name == "--host")			options.host = value;
+		else if (name == "--port")			options.port = std::stoi(value);
+		else if (name == "--connections")	options.connections = std::stoi(value);
+		else if (name == "--games")			options.games = std::stoi(value);
+		else if (name == "--seconds")		options.seconds = std::stod(value);
+		else if (name == "--mode")			options.mode = value;
+		else if (name == "--seed")			options.seed = std::stoull(value);
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.board == "3x3x3")
+		return Run<Board<3, 3, 3>>(options);
+	if (options.board == "15x15x5")
+		return Run<Board<15, 15, 5>>(options);
+	std::cout << "Unknown board " << options.board << std::endl;
+	return 1;
+}
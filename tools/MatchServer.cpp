@@ -0,0 +1,620 @@
+// Match server: hosts many independent games in one process for remote players and bots,
+// see source/MatchProtocol.h for the protocol. One thread runs an epoll reactor over all
+// connections; the games live in a slab allocated at startup, so a running server
+// allocates nothing per game or per move. Linux only.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -Isource tools/MatchServer.cpp -o MatchServer
+// Usage:
+//   MatchServer [options]
+//     --board 3x3x3 | 15x15x5   (default 3x3x3)
+//     --bind ADDRESS            (default 127.0.0.1)
+//     --port N                  (default 7777)
+//     --sessions N              most games at a time, at most 1048576 (default 65536)
+//     --seed N                  of the bot's random moves (default 1)
+// Every second with traffic it prints connections, games and moves/s; Ctrl+C stops it.
+// Load it with tools/MatchClient.cpp.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "Agent.h"
+#include "MatchProtocol.h"
+
+
+struct Options
+{
+	std::string board = "3x3x3";
+	std::string bind = "127.0.0.1";
+	int port = 7777;
+	uint32_t sessions = 65536;
+	uint64_t seed = 1;
+};
+
+const uint32_t NONE = 0xFFFFFFFF;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+
+// Fixed number of T, allocated up front. An id is the slot index in the low bits and the
+// slot's generation above them: once a slot is freed and reused, the old ids stop matching.
+template<typename T>
+class Slab
+{
+public:
+	static const int INDEX_BITS = 20;
+	static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+private:
+	std::vector<T> m_Items;
+	std::vector<uint32_t> m_Generations;
+	std::vector<uint32_t> m_Free;
+	// odd generations are in use
+	uint32_t m_Used;
+
+public:
+	explicit Slab(uint32_t capacity)
+		: m_Items(capacity), m_Generations(capacity, 0), m_Used(0)
+	{
+		m_Free.reserve(capacity);
+		for (uint32_t i = capacity; i > 0; i--)
+			m_Free.push_back(i - 1);
+	}
+
+	// NONE when the slab is full
+	uint32_t Allocate()
+	{
+		if (m_Free.empty())
+			return NONE;
+		uint32_t index = m_Free.back();
+		m_Free.pop_back();
+		m_Generations[index]++;
+		m_Used++;
+		m_Items[index] = T();
+		return IdOf(index);
+	}
+
+	void Free(uint32_t index)
+	{
+		m_Generations[index]++;
+		m_Free.push_back(index);
+		m_Used--;
+	}
+
+	// nullptr if the id is stale or was never handed out
+	T* Get(uint32_t id)
+	{
+		uint32_t index = id & INDEX_MASK;
+		if (index >= m_Items.size() || (m_Generations[index] & 1) == 0
+			|| (m_Generations[index] & (0xFFFFFFFFu >> INDEX_BITS)) != id >> INDEX_BITS)
+			return nullptr;
+		return &m_Items[index];
+	}
+
+	inline T& At(uint32_t index) { return m_Items[index]; }
+	inline uint32_t IdOf(uint32_t index) const { return (m_Generations[index] & (0xFFFFFFFFu >> INDEX_BITS)) << INDEX_BITS | index; }
+	inline uint32_t GetUsed() const { return m_Used; }
+};
+
+
+// A game and its two seats. Each seat with a client is linked into the list of games of that
+// client's connection (links are slot index * 2 + seat), so a disconnect finds its games at once.
+template<typename BoardType>
+struct Session
+{
+	BoardType board;
+	uint8_t mode = MODE_BOT;
+	int fd[2] = { -1, -1 };      // -1: the bot's seat, or nobody joined yet
+	uint32_t tag[2] = { 0, 0 };
+	uint32_t next[2] = { NONE, NONE };
+	uint32_t prev[2] = { NONE, NONE };
+};
+
+struct Connection
+{
+	bool open = false;
+	uint32_t games = NONE;
+	// the start of a message that didn't arrive whole
+	char partial[sizeof(MatchMessage)];
+	int partial_size = 0;
+	std::vector<char> out;
+	bool dirty = false;    // has output, listed in m_Dirty
+	bool writing = false;  // waiting for EPOLLOUT, the socket was full
+};
+
+
+template<typename BoardType>
+class MatchServer
+{
+private:
+	// a client that doesn't read its replies is cut off after this much
+	static const size_t MAX_OUTPUT = 4 << 20;
+
+	int m_Epoll;
+	int m_Listen;
+	Slab<Session<BoardType>> m_Sessions;
+	std::vector<Connection> m_Connections;  // by file descriptor
+	std::vector<int> m_Dirty;
+	RandomAgent<BoardType> m_Bot;
+	int m_ConnectionCount;
+	long long m_Moves;
+
+public:
+	MatchServer(const Options& options)
+		: m_Epoll(-1), m_Listen(-1), m_Sessions(options.sessions), m_Bot(options.seed), m_ConnectionCount(0), m_Moves(0) {}
+
+	~MatchServer()
+	{
+		for (size_t fd = 0; fd < m_Connections.size(); fd++)
+		{
+			if (m_Connections[fd].open)
+				close(static_cast<int>(fd));
+		}
+		if (m_Listen != -1)
+			close(m_Listen);
+		if (m_Epoll != -1)
+			close(m_Epoll);
+	}
+
+	bool Listen(const std::string& address, int port)
+	{
+		m_Listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+		int on = 1;
+		setsockopt(m_Listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<uint16_t>(port));
+		if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+		{
+			std::cout << "Bad address " << address << std::endl;
+			return false;
+		}
+		if (bind(m_Listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(m_Listen, SOMAXCONN) != 0)
+		{
+			std::cout << "Can't listen on " << address << ":" << port << ": " << std::strerror(errno) << std::endl;
+			return false;
+		}
+		m_Epoll = epoll_create1(0);
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = m_Listen;
+		epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_Listen, &event);
+		return true;
+	}
+
+	void Run()
+	{
+		const int MAX_EVENTS = 256;
+		epoll_event events[MAX_EVENTS];
+		std::vector<char> buffer(1 << 16);
+		auto report_time = std::chrono::steady_clock::now();
+		long long report_moves = 0;
+
+		while (!stop_requested)
+		{
+			int count = epoll_wait(m_Epoll, events, MAX_EVENTS, 1000);
+			for (int i = 0; i < count; i++)
+			{
+				int fd = events[i].data.fd;
+				if (fd == m_Listen)
+				{
+					Accept();
+					continue;
+				}
+				if (events[i].events & EPOLLOUT)
+					Flush(fd);
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+					Read(fd, buffer);
+			}
+			// the replies of a whole batch of events go out together, one send per connection.
+			// A failed send disconnects, which may tell other clients and grow the list meanwhile
+			for (size_t i = 0; i < m_Dirty.size(); i++)
+			{
+				int fd = m_Dirty[i];
+				m_Connections[fd].dirty = false;
+				if (m_Connections[fd].open && !m_Connections[fd].writing)
+					Flush(fd);
+			}
+			m_Dirty.clear();
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - report_time;
+			if (elapsed.count() >= 1.0)
+			{
+				if (m_Moves != report_moves)
+				{
+					std::cout << m_ConnectionCount << " connections, " << m_Sessions.GetUsed() << " games, "
+						<< static_cast<long long>((m_Moves - report_moves) / elapsed.count()) << " moves/s" << std::endl;
+				}
+				report_moves = m_Moves;
+				report_time = std::chrono::steady_clock::now();
+			}
+		}
+		std::cout << m_Moves << " moves played" << std::endl;
+	}
+
+private:
+	void Accept()
+	{
+		while (true)
+		{
+			int fd = accept4(m_Listen, nullptr, nullptr, SOCK_NONBLOCK);
+			if (fd == -1)
+			{
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+					std::cout << "Warning: accept failed: " << std::strerror(errno) << std::endl;
+				return;
+			}
+			// replies are small and latency matters, don't let Nagle hold them back
+			int on = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+			if (static_cast<size_t>(fd) >= m_Connections.size())
+				m_Connections.resize(fd + 1);
+			m_Connections[fd] = Connection();
+			m_Connections[fd].open = true;
+			m_ConnectionCount++;
+			epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+			epoll_ctl(m_Epoll, EPOLL_CTL_ADD, fd, &event);
+		}
+	}
+
+	void Read(int fd, std::vector<char>& buffer)
+	{
+		Connection& connection = m_Connections[fd];
+		if (!connection.open)
+			return;
+		// the partial message of the last read goes in front
+		std::memcpy(buffer.data(), connection.partial, connection.partial_size);
+		ssize_t received = recv(fd, buffer.data() + connection.partial_size, buffer.size() - connection.partial_size, 0);
+		if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+		{
+			Disconnect(fd);
+			return;
+		}
+		if (received < 0)
+			return;
+
+		size_t size = connection.partial_size + static_cast<size_t>(received);
+		size_t offset = 0;
+		for (; offset + sizeof(MatchMessage) <= size && connection.open; offset += sizeof(MatchMessage))
+		{
+			MatchMessage message;
+			std::memcpy(&message, buffer.data() + offset, sizeof(message));
+			Handle(fd, message);
+		}
+		if (!connection.open)
+			return;
+		connection.partial_size = static_cast<int>(size - offset);
+		std::memcpy(connection.partial, buffer.data() + offset, connection.partial_size);
+	}
+
+	void Handle(int fd, const MatchMessage& message)
+	{
+		switch (message.type)
+		{
+		case MSG_CREATE:
+			Create(fd, message);
+			return;
+		case MSG_JOIN:
+			Join(fd, message);
+			return;
+		case MSG_MOVE:
+			Move(fd, message);
+			return;
+		case MSG_RESET:
+			Reset(fd, message);
+			return;
+		case MSG_LEAVE:
+			Leave(fd, message);
+			return;
+		default:
+			Send(fd, { MSG_ERROR, ERROR_BAD_MESSAGE, 0, message.game, message.tag });
+		}
+	}
+
+	void Create(int fd, const MatchMessage& message)
+	{
+		if (message.status > MODE_PLAYERS)
+		{
+			Send(fd, { MSG_ERROR, ERROR_BAD_MESSAGE, 0, 0, message.tag });
+			return;
+		}
+		uint32_t id = m_Sessions.Allocate();
+		if (id == NONE)
+		{
+			Send(fd, { MSG_ERROR, ERROR_SERVER_FULL, 0, 0, message.tag });
+			return;
+		}
+		Session<BoardType>& session = *m_Sessions.Get(id);
+		session.mode = message.status;
+		session.fd[0] = fd;
+		session.tag[0] = message.tag;
+		// playing both sides needs only the one link
+		if (session.mode == MODE_LOCAL)
+		{
+			session.fd[1] = fd;
+			session.tag[1] = message.tag;
+		}
+		Link(id & Slab<Session<BoardType>>::INDEX_MASK, 0);
+		Send(fd, { MSG_CREATE | MSG_REPLY, session.mode, 0, id, message.tag });
+	}
+
+	void Join(int fd, const MatchMessage& message)
+	{
+		Session<BoardType>* session = m_Sessions.Get(message.game);
+		if (session == nullptr || session->mode != MODE_PLAYERS)
+		{
+			Send(fd, { MSG_ERROR, ERROR_NO_GAME, 0, message.game, message.tag });
+			return;
+		}
+		if (session->fd[1] != -1)
+		{
+			Send(fd, { MSG_ERROR, ERROR_SEAT_TAKEN, 0, message.game, message.tag });
+			return;
+		}
+		session->fd[1] = fd;
+		session->tag[1] = message.tag;
+		Link(message.game & Slab<Session<BoardType>>::INDEX_MASK, 1);
+		Send(fd, { MSG_JOIN | MSG_REPLY, OutcomeOf(session->board), 0, message.game, message.tag });
+		Send(session->fd[0], { MSG_OPPONENT_JOINED, 0, 0, message.game, session->tag[0] });
+	}
+
+	void Move(int fd, const MatchMessage& message)
+	{
+		Session<BoardType>* session = m_Sessions.Get(message.game);
+		int seat = session != nullptr ? SeatOf(*session, fd) : -1;
+		if (seat == -1)
+		{
+			Send(fd, { MSG_ERROR, ERROR_NO_GAME, message.cell, message.game, message.tag });
+			return;
+		}
+		BoardType& board = session->board;
+		int to_move = board.ToMove() == Figure::Cross ? 0 : 1;
+		uint8_t error = 0;
+		if (session->mode == MODE_PLAYERS && session->fd[1] == -1)
+			error = ERROR_NO_OPPONENT;
+		else if (session->fd[to_move] != fd)
+			error = ERROR_NOT_YOUR_TURN;
+		else if (!board.Play(message.cell))
+			error = ERROR_ILLEGAL_MOVE;
+		if (error != 0)
+		{
+			Send(fd, { MSG_ERROR, error, message.cell, message.game, session->tag[seat] });
+			return;
+		}
+		m_Moves++;
+
+		uint8_t outcome = OutcomeOf(board);
+		Send(fd, { MSG_MOVE | MSG_REPLY, outcome, message.cell, message.game, session->tag[to_move] });
+		if (session->mode == MODE_PLAYERS)
+			Send(session->fd[1 - to_move], { MSG_OPPONENT_MOVE, outcome, message.cell, message.game, session->tag[1 - to_move] });
+		else if (session->mode == MODE_BOT && outcome == OUTCOME_PLAYING)
+		{
+			int cell = m_Bot.ChooseMove(board);
+			board.Play(cell);
+			m_Moves++;
+			Send(fd, { MSG_OPPONENT_MOVE, OutcomeOf(board), static_cast<uint16_t>(cell), message.game, session->tag[0] });
+		}
+	}
+
+	void Reset(int fd, const MatchMessage& message)
+	{
+		Session<BoardType>* session = m_Sessions.Get(message.game);
+		int seat = session != nullptr ? SeatOf(*session, fd) : -1;
+		if (seat == -1)
+		{
+			Send(fd, { MSG_ERROR, ERROR_NO_GAME, 0, message.game, message.tag });
+			return;
+		}
+		session->board = BoardType();
+		Send(fd, { MSG_RESET | MSG_REPLY, OUTCOME_PLAYING, 0, message.game, session->tag[seat] });
+		if (session->mode == MODE_PLAYERS && session->fd[1 - seat] != -1)
+			Send(session->fd[1 - seat], { MSG_RESET | MSG_REPLY, OUTCOME_PLAYING, 0, message.game, session->tag[1 - seat] });
+	}
+
+	void Leave(int fd, const MatchMessage& message)
+	{
+		Session<BoardType>* session = m_Sessions.Get(message.game);
+		int seat = session != nullptr ? SeatOf(*session, fd) : -1;
+		if (seat == -1)
+		{
+			Send(fd, { MSG_ERROR, ERROR_NO_GAME, 0, message.game, message.tag });
+			return;
+		}
+		Send(fd, { MSG_LEAVE | MSG_REPLY, OutcomeOf(session->board), 0, message.game, session->tag[seat] });
+		CloseSession(message.game & Slab<Session<BoardType>>::INDEX_MASK, fd);
+	}
+
+	// 0 or 1, -1 if the client doesn't play in the game
+	static int SeatOf(const Session<BoardType>& session, int fd)
+	{
+		if (session.fd[0] == fd)
+			return 0;
+		return session.fd[1] == fd ? 1 : -1;
+	}
+
+	void Link(uint32_t index, int seat)
+	{
+		Session<BoardType>& session = m_Sessions.At(index);
+		Connection& connection = m_Connections[session.fd[seat]];
+		uint32_t link = index * 2 + seat;
+		session.prev[seat] = NONE;
+		session.next[seat] = connection.games;
+		if (connection.games != NONE)
+			m_Sessions.At(connection.games / 2).prev[connection.games % 2] = link;
+		connection.games = link;
+	}
+
+	void Unlink(uint32_t index, int seat)
+	{
+		Session<BoardType>& session = m_Sessions.At(index);
+		uint32_t prev = session.prev[seat], next = session.next[seat];
+		if (prev != NONE)
+			m_Sessions.At(prev / 2).next[prev % 2] = next;
+		else
+			m_Connections[session.fd[seat]].games = next;
+		if (next != NONE)
+			m_Sessions.At(next / 2).prev[next % 2] = prev;
+	}
+
+	// free the game, the other player (if it isn't the one leaving) is told
+	void CloseSession(uint32_t index, int leaving_fd)
+	{
+		Session<BoardType>& session = m_Sessions.At(index);
+		uint32_t id = m_Sessions.IdOf(index);
+		for (int seat = 0; seat < 2; seat++)
+		{
+			// seat 1 has a link of its own only when another client joined
+			if (session.fd[seat] == -1 || (seat == 1 && session.mode != MODE_PLAYERS))
+				continue;
+			Unlink(index, seat);
+			if (session.fd[seat] != leaving_fd)
+				Send(session.fd[seat], { MSG_CLOSED, OutcomeOf(session.board), 0, id, session.tag[seat] });
+		}
+		m_Sessions.Free(index);
+	}
+
+	void Disconnect(int fd)
+	{
+		Connection& connection = m_Connections[fd];
+		while (connection.games != NONE)
+			CloseSession(connection.games / 2, fd);
+		epoll_ctl(m_Epoll, EPOLL_CTL_DEL, fd, nullptr);
+		close(fd);
+		connection.open = false;
+		connection.out.clear();
+		connection.out.shrink_to_fit();
+		m_ConnectionCount--;
+	}
+
+	void Send(int fd, const MatchMessage& message)
+	{
+		Connection& connection = m_Connections[fd];
+		if (!connection.open)
+			return;
+		const char* bytes = reinterpret_cast<const char*>(&message);
+		connection.out.insert(connection.out.end(), bytes, bytes + sizeof(message));
+		if (!connection.dirty)
+		{
+			connection.dirty = true;
+			m_Dirty.push_back(fd);
+		}
+	}
+
+	void Flush(int fd)
+	{
+		Connection& connection = m_Connections[fd];
+		if (!connection.open)
+			return;
+		size_t sent = 0;
+		while (sent < connection.out.size())
+		{
+			ssize_t result = send(fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					Disconnect(fd);
+					return;
+				}
+				break;
+			}
+			sent += static_cast<size_t>(result);
+		}
+		connection.out.erase(connection.out.begin(), connection.out.begin() + sent);
+		if (connection.out.size() > MAX_OUTPUT)
+		{
+			std::cout << "Warning: dropping a client that doesn't read its replies" << std::endl;
+			Disconnect(fd);
+			return;
+		}
+		// wait for room in the socket only while there is something left
+		bool writing = !connection.out.empty();
+		if (writing != connection.writing)
+		{
+			epoll_event event = {};
+			event.events = EPOLLIN | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+			event.data.fd = fd;
+			epoll_ctl(m_Epoll, EPOLL_CTL_MOD, fd, &event);
+			connection.writing = writing;
+		}
+	}
+};
+
+
+void OnSignal(int)
+{
+	stop_requested = 1;
+}
+
+
+template<typename BoardType>
+int Run(const Options& options)
+{
+	if (options.sessions == 0 || options.sessions > (1u << Slab<Session<BoardType>>::INDEX_BITS))
+	{
+		std::cout << "Sessions must be between 1 and " << (1u << Slab<Session<BoardType>>::INDEX_BITS) << std::endl;
+		return 1;
+	}
+	MatchServer<BoardType> server(options);
+	if (!server.Listen(options.bind, options.port))
+		return 1;
+	std::cout << "Serving " << options.board << " games on " << options.bind << ":" << options.port
+		<< ", up to " << options.sessions << " at a time" << std::endl;
+	server.Run();
+	return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")			options.board = value;
+		else if (name == "--bind")		options.bind = value;
+		else if (name == "--port")		options.port = std::stoi(value);
+		else if (name == "--sessions")	options.sessions = static_cast<uint32_t>(std::stoul(value));
+		else if (name == "--seed")		options.seed = std::stoull(value);
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	std::signal(SIGINT, OnSignal);
+	std::signal(SIGTERM, OnSignal);
+	// one descriptor per client
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	if (options.board == "3x3x3")
+		return Run<Board<3, 3, 3>>(options);
+	if (options.board == "15x15x5")
+		return Run<Board<15, 15, 5>>(options);
+	std::cout << "Unknown board " << options.board << std::endl;
+	return 1;
+}
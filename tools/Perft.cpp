@@ -0,0 +1,315 @@
+// Perft: counts every move sequence from a position to a given depth, split by ply,
+// and the games that end on the way (x wins, o wins, draws). A yardstick for the move
+// generation and win detection of Board, and a check of them: the empty 3x3 board has
+// to give the known counts (255168 games) or the tool fails.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -pthread -Isource tools/Perft.cpp -o Perft
+// Usage:
+//   Perft [options]
+//     --board LIST       comma separated, of 3x3x3 | 4x4x3 | 4x4x4 | 5x5x4 | 15x15x5 (default 3x3x3)
+//     --depth N          plies from the position (default 9, at most the empty cells)
+//     --threads LIST     comma separated thread counts, 0 for all hardware threads (default 1,0)
+//     --moves CELLS      comma separated cells played before counting (default none)
+//     --repeat N         runs per configuration, the fastest is reported (default 1)
+//     --json FILE        append one JSON object per run, one per line, for trend tracking
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+
+#include "Board.h"
+#include "WorkStealingPool.h"
+
+
+struct Options
+{
+	std::vector<std::string> boards = { "3x3x3" };
+	int depth = 9;
+	std::vector<int> threads = { 1, 0 };
+	std::vector<int> moves;
+	int repeat = 1;
+	std::string json;
+};
+
+const int MAX_DEPTH = 256;
+
+
+// Per worker, added up at the end. nodes[ply]: positions reached after ply moves.
+struct PerftCounts
+{
+	long long nodes[MAX_DEPTH + 1] = {};
+	long long wins[3] = {};  // draw, cross, circle
+
+	void Add(const PerftCounts& other)
+	{
+		for (int i = 0; i <= MAX_DEPTH; i++)
+			nodes[i] += other.nodes[i];
+		for (int i = 0; i < 3; i++)
+			wins[i] += other.wins[i];
+	}
+
+	long long Nodes() const
+	{
+		long long total = 0;
+		for (long long count : nodes)
+			total += count;
+		return total;
+	}
+};
+
+
+// Empty 3x3 board to the end: move sequences of each length, and how the games end.
+const long long REFERENCE_3X3_NODES[10] = { 0, 9, 72, 504, 3024, 15120, 54720, 148176, 200448, 127872 };
+const long long REFERENCE_3X3_WINS[3] = { 46080, 131184, 77904 };
+
+
+// The children of a position are counted where they are generated: the ply they are on, and
+// the game's outcome if they end it. The position itself was counted by its parent.
+// Moves are played and taken back on the one board, nothing is copied.
+template<typename BoardType>
+void Perft(BoardType& board, int ply, int depth, PerftCounts& counts)
+{
+	for (int cell = 0; cell < BoardType::CELLS; cell++)
+	{
+		if (!board.IsEmpty(cell))
+			continue;
+		board.Play(cell);
+		counts.nodes[ply + 1]++;
+		if (board.IsOver())
+			counts.wins[static_cast<int>(board.Winner()) + 1]++;
+		else if (ply + 1 < depth)
+			Perft(board, ply + 1, depth, counts);
+		board.Undo();
+	}
+}
+
+// Above split_ply the children become tasks of the pool instead of being searched in place.
+template<typename BoardType>
+void PerftTask(WorkStealingPool& pool, const BoardType& board, int ply, int depth, int split_ply,
+	std::vector<PerftCounts>& counts, int worker)
+{
+	if (ply >= split_ply)
+	{
+		BoardType search = board;
+		Perft(search, ply, depth, counts[worker]);
+		return;
+	}
+	for (int cell = 0; cell < BoardType::CELLS; cell++)
+	{
+		if (!board.IsEmpty(cell))
+			continue;
+		BoardType child = board;
+		child.Play(cell);
+		counts[worker].nodes[ply + 1]++;
+		if (child.IsOver())
+			counts[worker].wins[static_cast<int>(child.Winner()) + 1]++;
+		else if (ply + 1 < depth)
+		{
+			pool.Submit([&pool, child, ply, depth, split_ply, &counts](int w)
+			{
+				PerftTask(pool, child, ply + 1, depth, split_ply, counts, w);
+			});
+		}
+	}
+}
+
+
+struct RunResult
+{
+	PerftCounts counts;
+	double seconds = 0.0;
+	int threads = 0;
+	int split_ply = 0;
+};
+
+template<typename BoardType>
+RunResult RunPerft(const BoardType& root, int depth, int threads)
+{
+	WorkStealingPool pool(threads);
+	RunResult result;
+	result.threads = pool.GetThreadCount();
+	// deep enough for some 16 tasks a thread, the stealing evens out the rest
+	int empty = BoardType::CELLS - root.MoveCount();
+	long long tasks = 1;
+	while (result.split_ply + 1 < depth && tasks < 16ll * result.threads)
+		tasks *= empty - result.split_ply++;
+
+	// one slot per worker, each many cache lines long
+	std::vector<PerftCounts> counts(result.threads);
+	auto start = std::chrono::steady_clock::now();
+	pool.Submit([&pool, &root, depth, &result, &counts](int worker)
+	{
+		PerftTask(pool, root, 0, depth, result.split_ply, counts, worker);
+	});
+	pool.Wait();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	result.seconds = elapsed.count();
+	for (const PerftCounts& worker_counts : counts)
+		result.counts.Add(worker_counts);
+	return result;
+}
+
+
+// 1 if the counts match the reference, 0 if they don't, -1 if there is no reference for the run
+template<typename BoardType>
+int CheckReference(const Options& options, int depth, const PerftCounts& counts)
+{
+	if (BoardType::WIDTH != 3 || BoardType::HEIGHT != 3 || BoardType::IN_A_ROW != 3 || !options.moves.empty())
+		return -1;
+	for (int ply = 1; ply <= depth && ply <= 9; ply++)
+	{
+		if (counts.nodes[ply] != REFERENCE_3X3_NODES[ply])
+			return 0;
+	}
+	// the outcomes are only known for the whole game
+	if (depth >= 9)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (counts.wins[i] != REFERENCE_3X3_WINS[i])
+				return 0;
+		}
+	}
+	return 1;
+}
+
+
+template<typename BoardType>
+int Run(const Options& options, const std::string& name)
+{
+	static_assert(BoardType::CELLS <= MAX_DEPTH, "Perft: more cells than plies counted");
+	BoardType root;
+	for (int cell : options.moves)
+	{
+		if (!root.Play(cell))
+		{
+			std::cout << "Can't play " << cell << " on " << name << std::endl;
+			return 1;
+		}
+	}
+	int depth = std::min(options.depth, BoardType::CELLS - root.MoveCount());
+	if (root.IsOver() || depth <= 0)
+	{
+		std::cout << "Nothing to count on " << name << std::endl;
+		return 1;
+	}
+
+	int failed = 0;
+	for (int threads : options.threads)
+	{
+		RunResult best;
+		for (int i = 0; i < options.repeat; i++)
+		{
+			RunResult result = RunPerft(root, depth, threads);
+			if (i == 0 || result.seconds < best.seconds)
+				best = result;
+		}
+		const PerftCounts& counts = best.counts;
+		long long nodes = counts.Nodes();
+		long long games = counts.wins[0] + counts.wins[1] + counts.wins[2];
+		double nodes_per_second = best.seconds > 0.0 ? nodes / best.seconds : 0.0;
+		int reference = CheckReference<BoardType>(options, depth, counts);
+		if (reference == 0)
+			failed = 1;
+
+		std::cout << name << " depth " << depth << ", " << best.threads << " threads (split at ply " << best.split_ply << "): "
+			<< nodes << " nodes in " << best.seconds << " s, " << static_cast<long long>(nodes_per_second) << " nodes/s" << std::endl;
+		for (int ply = 1; ply <= depth; ply++)
+			std::cout << "  ply " << ply << ": " << counts.nodes[ply] << std::endl;
+		std::cout << "  games " << games << ": x wins " << counts.wins[1] << ", o wins " << counts.wins[2]
+			<< ", draws " << counts.wins[0] << std::endl;
+		if (reference != -1)
+			std::cout << "  reference: " << (reference == 1 ? "ok" : "MISMATCH") << std::endl;
+
+		if (!options.json.empty())
+		{
+			std::ofstream json(options.json, std::ios::app);
+			json << "{\"time\":" << static_cast<long long>(std::time(nullptr)) << ",\"board\":\"" << name << "\",\"moves\":[";
+			for (size_t i = 0; i < options.moves.size(); i++)
+				json << (i != 0 ? "," : "") << options.moves[i];
+			json << "],\"depth\":" << depth << ",\"threads\":" << best.threads << ",\"split_ply\":" << best.split_ply
+				<< ",\"seconds\":" << best.seconds << ",\"nodes\":" << nodes
+				<< ",\"nodes_per_second\":" << static_cast<long long>(nodes_per_second) << ",\"plies\":[";
+			for (int ply = 1; ply <= depth; ply++)
+				json << (ply != 1 ? "," : "") << counts.nodes[ply];
+			json << "],\"games\":" << games << ",\"x_wins\":" << counts.wins[1] << ",\"o_wins\":" << counts.wins[2]
+				<< ",\"draws\":" << counts.wins[0] << ",\"reference\":"
+				<< (reference == -1 ? "null" : (reference == 1 ? "true" : "false")) << "}\n";
+			if (!json)
+			{
+				std::cout << "Failed to write " << options.json << std::endl;
+				failed = 1;
+			}
+		}
+	}
+	return failed;
+}
+
+
+std::vector<std::string> SplitList(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	return items;
+}
+
+std::vector<int> SplitNumbers(const std::string& list)
+{
+	std::vector<int> numbers;
+	for (const std::string& item : SplitList(list))
+		numbers.push_back(std::stoi(item));
+	return numbers;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")			options.boards = SplitList(value);
+		else if (name == "--depth")		options.depth = std::stoi(value);
+		else if (name == "--threads")	options.threads = SplitNumbers(value);
+		else if (name == "--moves")		options.moves = SplitNumbers(value);
+		else if (name == "--repeat")	options.repeat = std::max(1, std::stoi(value));
+		else if (name == "--json")		options.json = value;
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	int failed = 0;
+	for (const std::string& board : options.boards)
+	{
+		if (board == "3x3x3")
+			failed |= Run<Board<3, 3, 3>>(options, board);
+		else if (board == "4x4x3")
+			failed |= Run<Board<4, 4, 3>>(options, board);
+		else if (board == "4x4x4")
+			failed |= Run<Board<4, 4, 4>>(options, board);
+		else if (board == "5x5x4")
+			failed |= Run<Board<5, 5, 4>>(options, board);
+		else if (board == "15x15x5")
+			failed |= Run<Board<15, 15, 5>>(options, board);
+		else
+		{
+			std::cout << "Unknown board " << board << std::endl;
+			failed = 1;
+		}
+	}
+	return failed;
+}
@@ -0,0 +1,182 @@
+// Headless render benchmark: replays scripted games through BoardRenderer into an offscreen
+// frame buffer, one frame per move, and reports frames per second, per-frame latency
+// percentiles and a hash of the pixels of every finished game. The same run catches
+// performance and correctness regressions in Renderer, VertexArray and Shader.
+//
+// Build (needs GL like the game, glad.c comes with glad):
+//   g++ -O2 -std=c++14 -Isource tools/RenderBenchmark.cpp source/BoardRenderer.cpp source/Renderer.cpp
+//       source/Shader.cpp source/VertexBuffer.cpp source/VertexArray.cpp source/IndexBuffer.cpp
+//       source/FrameBuffer.cpp source/UniformBuffer.cpp source/GLState.cpp source/GLDebug.cpp
+//       source/MappedFile.cpp glad.c -lglfw -ldl -o RenderBenchmark
+// Usage (from the repository root, the shaders are loaded from resource/shaders):
+//   RenderBenchmark [options]
+//     --board 3x3x3 | 15x15x5   (default 3x3x3)
+//     --games N        scripted games of random moves (default 200)
+//     --size N         width and height of the frame buffer in pixels (default 690)
+//     --seed N         (default 1)
+//     --context native | egl | osmesa   how GLFW creates the context (default native)
+//     --shader-cache DIR   keep linked programs in DIR (default: compile every run). Run twice
+//                          with an empty DIR to compare the cold and the warm startup
+//
+// The window is never shown. Without a display, use --context osmesa (GLFW built with
+// OSMesa) or run under xvfb-run; Mesa's llvmpipe is fine. Every frame ends with glFinish,
+// so the latency covers the GPU work too. Pixel hashes are only comparable between runs
+// on the same driver.
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "BoardRenderer.h"
+#include "Agent.h"
+
+
+struct Options
+{
+	std::string board = "3x3x3";
+	long long games = 200;
+	int size = 690;
+	uint64_t seed = 1;
+	std::string context = "native";
+	std::string shader_cache;
+};
+
+
+// FNV-1a, continued over every read-back
+uint64_t HashPixels(uint64_t hash, const std::vector<unsigned char>& pixels)
+{
+	for (unsigned char byte : pixels)
+	{
+		hash ^= byte;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+
+template<typename BoardType>
+int Run(const Options& options)
+{
+	BoardGeometry geometry(BoardType::WIDTH, BoardType::HEIGHT);
+	auto setup_start = std::chrono::steady_clock::now();
+	Shader::SetCacheDirectory(options.shader_cache);
+	BoardRenderer board_renderer(geometry, options.size, options.size);
+	FrameBuffer target(options.size, options.size);
+	Renderer renderer;
+	RandomAgent<BoardType> agent(options.seed);
+
+	std::vector<double> latencies;
+	std::vector<unsigned char> pixels;
+	uint64_t hash = 14695981039346656037ull;
+
+	auto render = [&](const BoardType& board)
+	{
+		auto start = std::chrono::steady_clock::now();
+		renderer.BeginFrame();
+		board_renderer.SetBoard(board);
+		board_renderer.Render(renderer, options.size, options.size, &target);
+		GLCall(glFinish());
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count();
+	};
+
+	// compiles the shaders' pipelines and fills the grid cache
+	double first_frame = render(BoardType());
+	std::chrono::duration<double, std::milli> setup = std::chrono::steady_clock::now() - setup_start;
+
+	for (long long game = 0; game < options.games; game++)
+	{
+		BoardType board;
+		latencies.push_back(render(board));
+		while (!board.IsOver())
+		{
+			board.Play(agent.ChooseMove(board));
+			latencies.push_back(render(board));
+		}
+		target.ReadPixels(pixels);
+		hash = HashPixels(hash, pixels);
+	}
+
+	double total = 0.0;
+	for (double latency : latencies)
+		total += latency;
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]; };
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+	const Shader::LoadStatistics& shaders = Shader::GetLoadStatistics();
+	std::cout << "startup ms: " << setup.count() << " to the first frame (shaders " << shaders.seconds * 1000.0
+		<< ", " << shaders.cache_hits << " of " << shaders.programs << " from the cache; first frame " << first_frame << ")" << std::endl;
+	std::cout << latencies.size() << " frames of " << options.board << " at " << options.size << "x" << options.size << ": "
+		<< static_cast<long long>(latencies.size() / (total / 1000.0)) << " frames/s" << std::endl;
+	std::cout << "latency ms: p50 " << percentile(0.50) << ", p90 " << percentile(0.90) << ", p99 " << percentile(0.99)
+		<< ", max " << latencies.back() << std::endl;
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+	std::cout << "pixel hash " << hex << std::endl;
+	return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")			options.board = value;
+		else if (name == "--games")		options.games = std::stoll(value);
+		else if (name == "--size")		options.size = std::stoi(value);
+		else if (name == "--seed")		options.seed = std::stoull(value);
+		else if (name == "--context")	options.context = value;
+		else if (name == "--shader-cache")	options.shader_cache = value;
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (options.context == "egl")
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	else if (options.context == "osmesa")
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+	// the window only provides the context, everything is drawn into a frame buffer
+	GLFWwindow* window = glfwCreateWindow(64, 64, "RenderBenchmark", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "WARNING: Context creation failed (" << options.context << ")" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "WARNING: Failed to load GLAD" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	int result = 1;
+	if (options.board == "3x3x3")
+		result = Run<Board<3, 3, 3>>(options);
+	else if (options.board == "15x15x5")
+		result = Run<Board<15, 15, 5>>(options);
+	else
+		std::cout << "Unknown board " << options.board << std::endl;
+	glfwTerminate();
+	return result;
+}
@@ -0,0 +1,262 @@
+// Replays move logs written by the game (moves-*.log) through the game rules, without a
+// window, as fast as it can: to reproduce reported games and as a throughput benchmark
+// over a corpus of logs.
+//
+// Build (no GL or window needed):
+//   g++ -O2 -std=c++14 -Isource tools/Replay.cpp source/MoveLog.cpp source/MappedFile.cpp -o Replay
+// Usage:
+//   Replay [options] LOG...
+//     --repeat N     replay every log N times (default 1)
+//     --verbose      print every game: final board, result, time and event index of its end
+//   Replay --check   write logs with take-backs and of the older versions, replay them and compare every game
+//                    with the board its moves give without take-backs; exit code 1 on a mismatch
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <cstddef>
+#include <cstdio>
+
+#include "Board.h"
+#include "MoveLog.h"
+
+
+struct Options
+{
+	std::vector<std::string> logs;
+	long long repeat = 1;
+	bool verbose = false;
+	bool check = false;
+};
+
+
+template<typename BoardType>
+void PrintGame(const BoardType& board, const MoveEvent* events, size_t index)
+{
+	for (int y = 0; y < BoardType::HEIGHT; y++)
+	{
+		std::string row;
+		for (int x = 0; x < BoardType::WIDTH; x++)
+		{
+			Figure figure = board.At(y * BoardType::WIDTH + x);
+			row += figure == Figure::Cross ? 'x' : (figure == Figure::Circle ? 'o' : '.');
+		}
+		std::cout << "  " << row << std::endl;
+	}
+	Figure winner = board.Winner();
+	std::cout << "  " << board.MoveCount() << " moves, "
+		<< (winner == Figure::Cross ? "x wins" : (winner == Figure::Circle ? "o wins" : (board.IsOver() ? "draw" : "unfinished")))
+		<< ", ended at event " << index << " (" << events[index].time_ms << " ms)" << std::endl;
+}
+
+
+template<typename BoardType>
+ReplayResult Replay(const MoveLogReader& log, const Options& options)
+{
+	const MoveEvent* events = log.GetEvents();
+	bool verbose = options.verbose;
+	ReplayResult total;
+	for (long long i = 0; i < options.repeat; i++)
+	{
+		ReplayResult result = ReplayMoves<BoardType>(events, log.GetEventCount(), [&](const BoardType& board, size_t index)
+		{
+			if (verbose)
+				PrintGame(board, events, index);
+		});
+		// the games are the same every time
+		verbose = false;
+		total.events += result.events;
+		total.moves += result.moves;
+		total.rejected += result.rejected;
+		total.games += result.games;
+		for (int w = 0; w < 3; w++)
+			total.wins[w] += result.wins[w];
+	}
+	return total;
+}
+
+
+// --check
+//--------
+struct ScriptedEvent
+{
+	MoveEventType type;
+	int cell;
+};
+
+// 3x3 games with take-backs, and the moves that give each game's board without them
+const std::vector<ScriptedEvent> UNDO_SCRIPT = {
+	// taken back one and two at a time
+	{ EVENT_MOVE, 4 }, { EVENT_MOVE, 0 }, { EVENT_UNDO, 0 }, { EVENT_MOVE, 1 }, { EVENT_MOVE, 8 },
+	{ EVENT_UNDO, 8 }, { EVENT_UNDO, 1 }, { EVENT_MOVE, 2 }, { EVENT_RESET, 0 },
+	// x's winning move taken back, o wins instead (a reader skipping the take-back ends with x's win)
+	{ EVENT_MOVE, 0 }, { EVENT_MOVE, 3 }, { EVENT_MOVE, 1 }, { EVENT_MOVE, 4 }, { EVENT_MOVE, 2 },
+	{ EVENT_UNDO, 2 }, { EVENT_MOVE, 6 }, { EVENT_MOVE, 5 }, { EVENT_RESET, 0 },
+	// a refused move, and a take-back on the empty board that does nothing
+	{ EVENT_MOVE, 4 }, { EVENT_MOVE, 4 }, { EVENT_UNDO, 4 }, { EVENT_UNDO, 0 }, { EVENT_MOVE, 0 },
+};
+const std::vector<std::vector<int>> UNDO_GAMES = { { 4, 2 }, { 0, 3, 1, 4, 6, 5 }, { 0 } };
+
+// what a version 1 log holds: moves and resets
+const std::vector<ScriptedEvent> MOVE_SCRIPT = {
+	{ EVENT_MOVE, 4 }, { EVENT_MOVE, 0 }, { EVENT_MOVE, 2 }, { EVENT_MOVE, 6 }, { EVENT_MOVE, 3 },
+	{ EVENT_MOVE, 5 }, { EVENT_MOVE, 7 }, { EVENT_MOVE, 1 }, { EVENT_MOVE, 8 }, { EVENT_RESET, 0 },
+	{ EVENT_MOVE, 0 }, { EVENT_MOVE, 3 }, { EVENT_MOVE, 1 }, { EVENT_MOVE, 4 }, { EVENT_MOVE, 2 }, { EVENT_MOVE, 5 },
+};
+const std::vector<std::vector<int>> MOVE_GAMES = { { 4, 0, 2, 6, 3, 5, 7, 1, 8 }, { 0, 3, 1, 4, 2 } };
+
+
+// the script through MoveLogWriter, then the header's version is set to version
+bool WriteLog(const std::string& path, const std::vector<ScriptedEvent>& script, uint16_t version)
+{
+	MoveLogWriter writer;
+	if (!writer.Open(path, 3, 3, 3))
+		return false;
+	for (const ScriptedEvent& event : script)
+		writer.Append(event.type, SOURCE_HUMAN, event.cell);
+	writer.Close();
+
+	std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+	stream.seekp(offsetof(MoveLogHeader, version));
+	stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	return static_cast<bool>(stream);
+}
+
+// Writes the script as a log of the version, replays it and compares every game with the board of its moves.
+long long CheckLog(const std::string& path, const std::vector<ScriptedEvent>& script, uint16_t version,
+	const std::vector<std::vector<int>>& expected)
+{
+	using CheckBoard = Board<3, 3, 3>;
+	if (!WriteLog(path, script, version))
+	{
+		std::cout << "Can't write " << path << std::endl;
+		return 1;
+	}
+	std::vector<CheckBoard> games;
+	bool opened;
+	{
+		MoveLogReader log;
+		opened = log.Open(path);
+		if (opened)
+			ReplayMoves<CheckBoard>(log.GetEvents(), log.GetEventCount(), [&](const CheckBoard& board, size_t) { games.push_back(board); });
+	}
+	std::remove(path.c_str());
+	if (!opened)
+	{
+		std::cout << "Log version " << version << ": refused" << std::endl;
+		return 1;
+	}
+
+	long long mismatches = games.size() == expected.size() ? 0 : 1;
+	for (size_t i = 0; i < games.size() && i < expected.size(); i++)
+	{
+		CheckBoard board;
+		for (int cell : expected[i])
+			board.Play(cell);
+		bool same = board.MoveCount() == games[i].MoveCount() && board.Winner() == games[i].Winner();
+		for (int cell = 0; cell < CheckBoard::CELLS; cell++)
+			same = same && board.At(cell) == games[i].At(cell);
+		if (!same)
+			mismatches++;
+	}
+	std::cout << "Log version " << version << ": " << games.size() << " games, " << mismatches << " mismatches" << std::endl;
+	return mismatches;
+}
+
+int RunCheck()
+{
+	const std::string path = "replay-check.log";
+	long long failures = CheckLog(path, UNDO_SCRIPT, MoveLogWriter::VERSION, UNDO_GAMES);
+	for (uint16_t version = MoveLogWriter::MIN_VERSION; version < MoveLogWriter::VERSION; version++)
+		failures += CheckLog(path, MOVE_SCRIPT, version, MOVE_GAMES);
+
+	// a log from a newer writer may hold events this reader doesn't know, it has to be refused
+	bool refused = false;
+	if (WriteLog(path, MOVE_SCRIPT, MoveLogWriter::VERSION + 1))
+	{
+		MoveLogReader log;
+		refused = !log.Open(path);
+	}
+	std::remove(path.c_str());
+	std::cout << "Log version " << MoveLogWriter::VERSION + 1 << ": " << (refused ? "refused" : "accepted") << std::endl;
+	if (!refused)
+		failures++;
+	return failures == 0 ? 0 : 1;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string name = argv[i];
+		if (name == "--repeat" && i + 1 < argc)
+			options.repeat = std::stoll(argv[++i]);
+		else if (name == "--verbose")
+			options.verbose = true;
+		else if (name == "--check")
+			options.check = true;
+		else if (name.compare(0, 2, "--") == 0)
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+		else
+			options.logs.push_back(name);
+	}
+	if (options.check)
+		return RunCheck();
+	if (options.logs.empty())
+	{
+		std::cout << "Usage: Replay [--repeat N] [--verbose] LOG... | Replay --check" << std::endl;
+		return 1;
+	}
+
+	ReplayResult total;
+	double seconds = 0.0;
+	for (const std::string& path : options.logs)
+	{
+		MoveLogReader log;
+		if (!log.Open(path))
+			return 1;
+		const MoveLogHeader& header = log.GetHeader();
+		if (options.verbose)
+			std::cout << path << ": " << log.GetEventCount() << " events" << std::endl;
+
+		auto start = std::chrono::steady_clock::now();
+		ReplayResult result;
+		if (log.IsFor(3, 3, 3))
+			result = Replay<Board<3, 3, 3>>(log, options);
+		else if (log.IsFor(4, 4, 3))
+			result = Replay<Board<4, 4, 3>>(log, options);
+		else if (log.IsFor(4, 4, 4))
+			result = Replay<Board<4, 4, 4>>(log, options);
+		else if (log.IsFor(15, 15, 5))
+			result = Replay<Board<15, 15, 5>>(log, options);
+		else
+		{
+			std::cout << path << ": unsupported board " << int(header.width) << "x" << int(header.height) << "x" << int(header.in_a_row) << std::endl;
+			return 1;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		seconds += elapsed.count();
+
+		total.events += result.events;
+		total.moves += result.moves;
+		total.rejected += result.rejected;
+		total.games += result.games;
+		for (int w = 0; w < 3; w++)
+			total.wins[w] += result.wins[w];
+	}
+
+	std::cout << total.events << " events, " << total.games << " games (" << total.moves << " moves, "
+		<< total.rejected << " rejected) in " << seconds << " s";
+	if (seconds > 0.0)
+		std::cout << ": " << static_cast<long long>(total.events / seconds) << " events/s";
+	std::cout << std::endl;
+	std::cout << "x wins " << total.wins[1] << ", o wins " << total.wins[2] << ", draws or unfinished " << total.wins[0] << std::endl;
+	return 0;
+}
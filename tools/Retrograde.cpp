@@ -0,0 +1,165 @@
+// Retrograde: solves every position of a board out of core with RetrogradeSolver, one value
+// file per figure count, and checks the tables against Solver's search on positions from
+// random games. Stop it at any time, running it again resumes at the first unwritten chunk.
+//
+// Build (no GL needed):
+//   g++ -O2 -std=c++14 -pthread -Isource tools/Retrograde.cpp source/MappedFile.cpp -o Retrograde
+// Usage:
+//   Retrograde [options]
+//     --board 3x3x3 | 4x4x3 | 4x4x4 | 5x4x3 | 5x4x4   (default 4x4x3)
+//     --dir DIR          where the tables go, created if missing (default retrograde)
+//     --threads N        (default: all hardware threads)
+//     --chunk N          positions per task and per write (default 4194304)
+//     --verify N         positions from random games checked against Solver (default 200)
+//     --seed N           (default 1)
+//
+// Disk: 1 byte per position, 6046 for 3x3, 10 MB for 4x4, 741 MB for 5x4.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "Board.h"
+#include "Agent.h"
+#include "Solver.h"
+#include "RetrogradeSolver.h"
+#include "WorkStealingPool.h"
+
+
+struct Options
+{
+	std::string board = "4x4x3";
+	std::string directory = "retrograde";
+	int threads = 0;
+	uint64_t chunk = uint64_t(1) << 22;
+	int verify = 200;
+	uint64_t seed = 1;
+};
+
+
+const char* Describe(int value)
+{
+	return value > 0 ? "win" : (value < 0 ? "loss" : "draw");
+}
+
+
+// Plays random games and compares every position on the way with a search, until count positions.
+template<typename BoardType>
+int Verify(const RetrogradeSolver<BoardType>& tables, int count, uint64_t seed)
+{
+	Solver<BoardType> solver(22);
+	RandomAgent<BoardType> random(seed);
+	int checked = 0, mismatches = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (checked < count)
+	{
+		BoardType board;
+		// the search from the first few moves of the bigger boards takes long, skip ahead
+		while (!board.IsOver() && board.MoveCount() < BoardType::CELLS / 4)
+			board.Play(random.ChooseMove(board));
+		while (checked < count)
+		{
+			int expected = solver.Solve(board), value = tables.Value(board);
+			checked++;
+			if (expected != value)
+			{
+				mismatches++;
+				std::cout << "Mismatch after " << board.MoveCount() << " moves: table " << value << ", search " << expected << std::endl;
+			}
+			if (board.IsOver())
+				break;
+			board.Play(random.ChooseMove(board));
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Verified " << checked << " positions against the search in " << elapsed.count() << " s, "
+		<< mismatches << " mismatches" << std::endl;
+	return mismatches == 0 ? 0 : 1;
+}
+
+
+template<typename BoardType>
+int Run(const Options& options)
+{
+#ifdef _WIN32
+	_mkdir(options.directory.c_str());
+#else
+	mkdir(options.directory.c_str(), 0755);
+#endif
+	RetrogradeSolver<BoardType> tables(options.directory, options.chunk);
+	WorkStealingPool pool(options.threads);
+	std::cout << "Solving " << options.board << " into " << options.directory << " on " << pool.GetThreadCount() << " threads" << std::endl;
+
+	uint64_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	bool solved = tables.Solve(pool, [&](const typename RetrogradeSolver<BoardType>::LayerStatistics& layer)
+	{
+		total += layer.positions;
+		std::cout << "  " << std::setw(2) << layer.stones << " figures: " << std::setw(10) << layer.positions << " positions";
+		if (layer.resumed_chunks == layer.chunks)
+		{
+			std::cout << ", done before" << std::endl;
+			return;
+		}
+		if (layer.resumed_chunks != 0)
+			std::cout << ", " << layer.resumed_chunks << "/" << layer.chunks << " chunks done before";
+		std::cout << ", to move: " << layer.wins << " win " << layer.draws << " draw " << layer.losses << " loss, "
+			<< layer.seconds << " s (" << static_cast<long long>((layer.wins + layer.draws + layer.losses) / std::max(layer.seconds, 1e-9))
+			<< " positions/s)" << std::endl;
+	});
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	if (!solved || !tables.Open())
+	{
+		std::cout << "Failed to write or read the tables in " << options.directory << std::endl;
+		return 1;
+	}
+	std::cout << total << " positions in " << elapsed.count() << " s" << std::endl;
+
+	BoardType empty;
+	int value = tables.Value(empty);
+	std::cout << options.board << " is a " << Describe(value) << " for the first player (value " << value
+		<< "), best first move " << tables.BestMove(empty) << std::endl;
+	return options.verify > 0 ? Verify(tables, options.verify, options.seed) : 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")			options.board = value;
+		else if (name == "--dir")		options.directory = value;
+		else if (name == "--threads")	options.threads = std::stoi(value);
+		else if (name == "--chunk")		options.chunk = std::stoull(value);
+		else if (name == "--verify")	options.verify = std::stoi(value);
+		else if (name == "--seed")		options.seed = std::stoull(value);
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.board == "3x3x3")
+		return Run<Board<3, 3, 3>>(options);
+	if (options.board == "4x4x3")
+		return Run<Board<4, 4, 3>>(options);
+	if (options.board == "4x4x4")
+		return Run<Board<4, 4, 4>>(options);
+	if (options.board == "5x4x3")
+		return Run<Board<5, 4, 3>>(options);
+	if (options.board == "5x4x4")
+		return Run<Board<5, 4, 4>>(options);
+	std::cout << "Unknown board " << options.board << std::endl;
+	return 1;
+}
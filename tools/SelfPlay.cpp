@@ -0,0 +1,251 @@
+// Headless self-play: plays many games between two agents on a pool of threads
+// and streams every game (moves, winner, winning line) to a CSV or binary file.
+//
+// Build (no GL or window needed):
+//   g++ -O2 -std=c++14 -pthread -Isource tools/SelfPlay.cpp -o SelfPlay
+// Usage:
+//   SelfPlay [options]
+//     --board 3x3x3 | 4x4x3 | 4x4x4 | 15x15x5   (default 3x3x3)
+//     --x random | solver | mcts                 agent playing crosses (default random)
+//     --o random | solver | mcts                 agent playing circles (default random)
+//     --games N          (default 1000000)
+//     --threads N        (default: all hardware threads)
+//     --playouts N       MCTS playouts per move (default 1000)
+//     --seed N           (default 1)
+//     --output FILE      (default games.csv, a .bin name selects the binary format)
+//
+// Binary format (little-endian): "TTTG", uint16 version, uint8 width, height, in a row,
+// then per game: uint8 move count, int8 winner (-1 draw, 0 cross, 1 circle),
+// move count cells, and in a row cells of the winning line when there is a winner.
+// Cells are bytes, so boards are limited to 256 cells.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+
+#include "Board.h"
+#include "Agent.h"
+
+
+struct Options
+{
+	std::string board = "3x3x3";
+	std::string cross_agent = "random";
+	std::string circle_agent = "random";
+	long long games = 1000000;
+	int threads = 0;
+	uint64_t playouts = 1000;
+	uint64_t seed = 1;
+	std::string output = "games.csv";
+};
+
+
+// The only thing the workers share: whole buffers are appended under the lock.
+class GameWriter
+{
+private:
+	std::ofstream m_Stream;
+	std::mutex m_Mutex;
+
+public:
+	explicit GameWriter(const std::string& filepath)
+		: m_Stream(filepath, std::ios::binary) {}
+
+	bool IsOpen() const { return static_cast<bool>(m_Stream); }
+
+	void Write(const std::string& buffer)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stream.write(buffer.data(), buffer.size());
+	}
+};
+
+
+struct WorkerResult
+{
+	long long games = 0;
+	long long moves = 0;
+	long long wins[3] = {};  // draw, cross, circle
+};
+
+
+template<typename BoardType>
+void AppendGame(std::string& buffer, bool binary, long long index, const int* moves, int move_count, const BoardType& board)
+{
+	Figure winner = board.Winner();
+	if (binary)
+	{
+		buffer.push_back(static_cast<char>(move_count));
+		buffer.push_back(static_cast<char>(winner));
+		for (int i = 0; i < move_count; i++)
+			buffer.push_back(static_cast<char>(moves[i]));
+		for (int cell = 0; cell < BoardType::CELLS && winner != Figure::None; cell++)
+		{
+			if (board.IsOnWinningLine(cell))
+				buffer.push_back(static_cast<char>(cell));
+		}
+		return;
+	}
+
+	// game,moves,winner,winning line
+	buffer += std::to_string(index);
+	buffer += ',';
+	for (int i = 0; i < move_count; i++)
+	{
+		if (i != 0)
+			buffer += ' ';
+		buffer += std::to_string(moves[i]);
+	}
+	buffer += winner == Figure::Cross ? ",x," : (winner == Figure::Circle ? ",o," : ",-,");
+	bool first = true;
+	for (int cell = 0; cell < BoardType::CELLS && winner != Figure::None; cell++)
+	{
+		if (board.IsOnWinningLine(cell))
+		{
+			if (!first)
+				buffer += ' ';
+			buffer += std::to_string(cell);
+			first = false;
+		}
+	}
+	buffer += '\n';
+}
+
+
+// Plays games [first, last) with its own agents and buffer.
+template<typename BoardType>
+void Work(const Options& options, bool binary, long long first, long long last, int worker, GameWriter& writer, WorkerResult& result)
+{
+	const size_t FLUSH_SIZE = 1 << 20;
+	uint64_t seed = options.seed * 1000003 + worker * 2;
+	auto cross = MakeAgent<BoardType>(options.cross_agent, seed, options.playouts);
+	auto circle = MakeAgent<BoardType>(options.circle_agent, seed + 1, options.playouts);
+	std::string buffer;
+	buffer.reserve(FLUSH_SIZE + 4096);
+	int moves[BoardType::CELLS];
+	// counted locally, so the workers don't fight over cache lines of the shared results
+	WorkerResult local;
+
+	for (long long game = first; game < last; game++)
+	{
+		BoardType board;
+		int move_count = 0;
+		while (!board.IsOver())
+		{
+			Agent<BoardType>& agent = (board.ToMove() == Figure::Cross) ? *cross : *circle;
+			int cell = agent.ChooseMove(board);
+			board.Play(cell);
+			moves[move_count++] = cell;
+		}
+		AppendGame(buffer, binary, game, moves, move_count, board);
+		local.games++;
+		local.moves += move_count;
+		local.wins[static_cast<int>(board.Winner()) + 1]++;
+
+		if (buffer.size() >= FLUSH_SIZE)
+		{
+			writer.Write(buffer);
+			buffer.clear();
+		}
+	}
+	writer.Write(buffer);
+	result = local;
+}
+
+
+template<typename BoardType>
+int Run(const Options& options)
+{
+	static_assert(BoardType::CELLS <= 256, "SelfPlay: cells are written as bytes");
+	for (const std::string& name : { options.cross_agent, options.circle_agent })
+	{
+		if (MakeAgent<BoardType>(name, 0, 1) == nullptr)
+		{
+			std::cout << "Agent " << name << " can't play " << options.board << std::endl;
+			return 1;
+		}
+	}
+
+	bool binary = options.output.size() > 4 && options.output.compare(options.output.size() - 4, 4, ".bin") == 0;
+	GameWriter writer(options.output);
+	if (!writer.IsOpen())
+	{
+		std::cout << "Failed to open " << options.output << std::endl;
+		return 1;
+	}
+	if (binary)
+	{
+		char header[9] = { 'T', 'T', 'T', 'G', 1, 0,
+			static_cast<char>(BoardType::WIDTH), static_cast<char>(BoardType::HEIGHT), static_cast<char>(BoardType::IN_A_ROW) };
+		writer.Write(std::string(header, sizeof(header)));
+	}
+	else
+		writer.Write("game,moves,winner,line\n");
+
+	int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+	std::vector<WorkerResult> results(threads);
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < threads; i++)
+	{
+		long long first = options.games * i / threads, last = options.games * (i + 1) / threads;
+		workers.emplace_back(Work<BoardType>, std::cref(options), binary, first, last, i, std::ref(writer), std::ref(results[i]));
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	WorkerResult total;
+	for (const WorkerResult& result : results)
+	{
+		total.games += result.games;
+		total.moves += result.moves;
+		for (int i = 0; i < 3; i++)
+			total.wins[i] += result.wins[i];
+	}
+	std::cout << total.games << " games (" << options.cross_agent << " vs " << options.circle_agent << ") on "
+		<< threads << " threads in " << elapsed.count() << " s: "
+		<< static_cast<long long>(total.games / elapsed.count()) << " games/s, "
+		<< static_cast<long long>(total.moves / elapsed.count()) << " moves/s" << std::endl;
+	std::cout << "x wins " << total.wins[1] << ", o wins " << total.wins[2] << ", draws " << total.wins[0] << std::endl;
+	return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--board")			options.board = value;
+		else if (name == "--x")			options.cross_agent = value;
+		else if (name == "--o")			options.circle_agent = value;
+		else if (name == "--games")		options.games = std::stoll(value);
+		else if (name == "--threads")	options.threads = std::stoi(value);
+		else if (name == "--playouts")	options.playouts = std::stoull(value);
+		else if (name == "--seed")		options.seed = std::stoull(value);
+		else if (name == "--output")	options.output = value;
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.board == "3x3x3")
+		return Run<Board<3, 3, 3>>(options);
+	if (options.board == "4x4x3")
+		return Run<Board<4, 4, 3>>(options);
+	if (options.board == "4x4x4")
+		return Run<Board<4, 4, 4>>(options);
+	if (options.board == "15x15x5")
+		return Run<Board<15, 15, 5>>(options);
+	std::cout << "Unknown board " << options.board << std::endl;
+	return 1;
+}
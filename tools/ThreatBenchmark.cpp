@@ -0,0 +1,209 @@
+// Threat evaluator benchmark on 15x15 Gomoku: replays random games and measures evaluations
+// per second for a full rescan of all lines (vector and scalar) against the incremental
+// update after each move, and for trying every empty cell with Play / Score / Remove the way
+// a search would. Every position is also checked: the incremental counts have to match a
+// full rescan, and a finished line has to agree with Board's winner.
+//
+// Build (no GL needed), the vector path needs AVX2:
+//   g++ -O2 -std=c++14 -mavx2 -Isource tools/ThreatBenchmark.cpp -o ThreatBenchmark
+// Usage:
+//   ThreatBenchmark [options]
+//     --games N          random games to replay (default 1000)
+//     --repeat N         passes over the games per measurement, the fastest is reported (default 3)
+//     --seed N           (default 1)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include "Board.h"
+#include "Agent.h"
+#include "ThreatEvaluator.h"
+
+
+using GomokuBoard = Board<15, 15, 5>;
+using Evaluator = ThreatEvaluator<15, 15, 5>;
+
+
+struct Options
+{
+	int games = 1000;
+	int repeat = 3;
+	uint64_t seed = 1;
+};
+
+
+bool SameThreats(const Evaluator::Threats& a, const Evaluator::Threats& b)
+{
+	return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+
+// Incremental against both rescans, and the line count against the board, after every move.
+long long Check(const std::vector<std::vector<int>>& games)
+{
+	long long mismatches = 0;
+	Evaluator incremental, full, scalar;
+	for (const std::vector<int>& moves : games)
+	{
+		GomokuBoard board;
+		incremental.Clear();
+		for (int cell : moves)
+		{
+			Figure figure = board.ToMove();
+			board.Play(cell);
+			incremental.Play(cell, figure);
+			full.Reset(board);
+			scalar.Reset(board);
+			scalar.RescanScalar();
+			for (Figure side : { Figure::Cross, Figure::Circle })
+			{
+				bool line = incremental.GetThreats(side).windows[GomokuBoard::IN_A_ROW] != 0;
+				if (!SameThreats(incremental.GetThreats(side), full.GetThreats(side))
+					|| !SameThreats(incremental.GetThreats(side), scalar.GetThreats(side))
+					|| line != (board.Winner() == side))
+					mismatches++;
+			}
+			// take the move back and put it in again, that has to land on the same counts
+			incremental.Remove(cell);
+			incremental.Play(cell, figure);
+			if (!SameThreats(incremental.GetThreats(Figure::Cross), full.GetThreats(Figure::Cross)))
+				mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+
+// Runs pass over all games repeat times, returns the best evaluations per second.
+template<typename Pass>
+double Measure(int repeat, long long evaluations, Pass pass)
+{
+	double best = 0.0;
+	for (int i = 0; i < repeat; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		pass();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::max(best, evaluations / elapsed.count());
+	}
+	return best;
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--games")			options.games = std::stoi(value);
+		else if (name == "--repeat")	options.repeat = std::stoi(value);
+		else if (name == "--seed")		options.seed = std::stoull(value);
+		else
+		{
+			std::cout << "Unknown option " << name << std::endl;
+			return 1;
+		}
+	}
+
+	// the games are generated up front, so the measurements only see the evaluator
+	std::vector<std::vector<int>> games;
+	RandomAgent<GomokuBoard> random(options.seed);
+	long long positions = 0, tries = 0;
+	for (int game = 0; game < options.games; game++)
+	{
+		GomokuBoard board;
+		std::vector<int> moves;
+		while (!board.IsOver())
+		{
+			tries += GomokuBoard::CELLS - board.MoveCount();
+			int cell = random.ChooseMove(board);
+			board.Play(cell);
+			moves.push_back(cell);
+		}
+		positions += moves.size();
+		games.push_back(moves);
+	}
+	std::cout << options.games << " random 15x15 games, " << positions << " positions, vector path "
+		<< (Evaluator::IsVectorized() ? "AVX2" : "off (build with -mavx2)") << std::endl;
+
+	long long mismatches = Check(games);
+	std::cout << "Incremental against full rescan: " << mismatches << " mismatches" << std::endl;
+
+	// keeps the scores alive so the work isn't optimized away
+	long long sink = 0;
+	Evaluator evaluator;
+	double full = Measure(options.repeat, positions, [&]
+	{
+		for (const std::vector<int>& moves : games)
+		{
+			evaluator.Clear();
+			for (size_t i = 0; i < moves.size(); i++)
+			{
+				evaluator.Set(moves[i], i % 2 == 0 ? Figure::Cross : Figure::Circle);
+				evaluator.Rescan();
+				sink += evaluator.Score(Figure::Cross);
+			}
+		}
+	});
+	double scalar = Measure(options.repeat, positions, [&]
+	{
+		for (const std::vector<int>& moves : games)
+		{
+			evaluator.Clear();
+			for (size_t i = 0; i < moves.size(); i++)
+			{
+				evaluator.Set(moves[i], i % 2 == 0 ? Figure::Cross : Figure::Circle);
+				evaluator.RescanScalar();
+				sink += evaluator.Score(Figure::Cross);
+			}
+		}
+	});
+	double incremental = Measure(options.repeat, positions, [&]
+	{
+		for (const std::vector<int>& moves : games)
+		{
+			evaluator.Clear();
+			for (size_t i = 0; i < moves.size(); i++)
+			{
+				evaluator.Play(moves[i], i % 2 == 0 ? Figure::Cross : Figure::Circle);
+				sink += evaluator.Score(Figure::Cross);
+			}
+		}
+	});
+	// every empty cell of every position, played, scored and taken back
+	double search = Measure(options.repeat, tries, [&]
+	{
+		for (const std::vector<int>& moves : games)
+		{
+			GomokuBoard board;
+			evaluator.Clear();
+			for (int cell : moves)
+			{
+				Figure side = board.ToMove();
+				for (int candidate = 0; candidate < GomokuBoard::CELLS; candidate++)
+				{
+					if (!board.IsEmpty(candidate))
+						continue;
+					evaluator.Play(candidate, side);
+					sink += evaluator.Score(side);
+					evaluator.Remove(candidate);
+				}
+				board.Play(cell);
+				evaluator.Play(cell, side);
+			}
+		}
+	});
+
+	std::cout << "Full rescan" << (Evaluator::IsVectorized() ? " (AVX2)" : "") << ": " << static_cast<long long>(full) << " evaluations/s" << std::endl;
+	std::cout << "Full rescan (scalar): " << static_cast<long long>(scalar) << " evaluations/s" << std::endl;
+	std::cout << "Incremental: " << static_cast<long long>(incremental) << " evaluations/s, "
+		<< incremental / full << "x the full rescan" << std::endl;
+	std::cout << "Play / Score / Remove per empty cell: " << static_cast<long long>(search) << " evaluations/s" << std::endl;
+	std::cout << "(checksum " << sink << ")" << std::endl;
+	return mismatches == 0 ? 0 : 1;
+}